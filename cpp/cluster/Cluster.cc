@@ -19,6 +19,9 @@ void Cluster::compute(const freud::locality::NeighborQuery* nq, const freud::loc
     m_cluster_idx.prepare(num_points);
     DisjointSets dj(num_points);
 
+    // Clusters only depend on which points are bonded, so each pair only
+    // needs to be found once.
+    qargs.unique_pairs = freud::locality::canFindUniquePairs(nq, nq->getPoints(), num_points, qargs, nlist);
     freud::locality::loopOverNeighbors(
         nq, nq->getPoints(), num_points, qargs, nlist,
         [&dj](const freud::locality::NeighborBond& neighbor_bond) {
@@ -30,12 +30,12 @@ CorrelationFunction<T>::CorrelationFunction(unsigned int bins, float r_max) : Bo
     // for the actual correlation function. The counts are used to normalize
     // the correlation function.
     util::Histogram<unsigned int>::Axes axes;
-    axes.push_back(std::make_shared<util::RegularAxis>(bins, 0, r_max));
+    axes.push_back(util::RegularAxis(bins, 0, r_max));
     m_histogram = util::Histogram<unsigned int>(axes);
     m_local_histograms = util::Histogram<unsigned int>::ThreadLocalHistogram(m_histogram);
 
     typename util::Histogram<T>::Axes axes_rdf;
-    axes_rdf.push_back(std::make_shared<util::RegularAxis>(bins, 0, r_max));
+    axes_rdf.push_back(util::RegularAxis(bins, 0, r_max));
     m_correlation_function = util::Histogram<T>(axes_rdf);
     m_local_correlation_function = CFThreadHistogram(m_correlation_function);
 }
@@ -85,14 +85,27 @@ void CorrelationFunction<T>::accumulate(const freud::locality::NeighborQuery* ne
                                         const freud::locality::NeighborList* nlist,
                                         freud::locality::QueryArgs qargs)
 {
+    // If the points and values are queried against themselves, each pair
+    // only needs to be found once and accumulated in both directions.
+    const bool unique_pairs
+        = (query_values == values)
+        && freud::locality::canFindUniquePairs(neighbor_query, query_points, n_query_points, qargs, nlist);
+    qargs.unique_pairs = unique_pairs;
     accumulateGeneral(
         neighbor_query, query_points, n_query_points, nlist, qargs,
         [=](const freud::locality::NeighborBond& neighbor_bond) {
-            size_t value_bin = m_histogram.bin({neighbor_bond.distance});
+            size_t value_bin = m_histogram.bin(neighbor_bond.distance);
             m_local_histograms.increment(value_bin);
             m_local_correlation_function.increment(
                 value_bin,
                 product(values[neighbor_bond.point_idx], query_values[neighbor_bond.query_point_idx]));
+            if (unique_pairs && neighbor_bond.query_point_idx != neighbor_bond.point_idx)
+            {
+                m_local_histograms.increment(value_bin);
+                m_local_correlation_function.increment(
+                    value_bin,
+                    product(values[neighbor_bond.query_point_idx], query_values[neighbor_bond.point_idx]));
+            }
         });
 }
 
@@ -67,6 +67,8 @@ void GaussianDensity::compute(const freud::locality::NeighborQuery* nq)
     const float A = std::sqrt(1.0f / (constants::TWO_PI * sigmasq));
 
     util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        const auto bin_counts = local_bin_counts.local().view<3>();
+
         // for each reference point
         for (size_t idx = begin; idx < end; ++idx)
         {
@@ -119,7 +121,7 @@ void GaussianDensity::compute(const freud::locality::NeighborQuery* nq)
 
                             // store the product of these values in an array - n[i, j, k]
                             // = gx*gy*gz
-                            local_bin_counts.local()(ni, nj, nk) += x_gaussian * y_gaussian * z_gaussian;
+                            bin_counts(ni, nj, nk) += x_gaussian * y_gaussian * z_gaussian;
                         }
                     }
                 }
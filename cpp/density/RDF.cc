@@ -23,7 +23,7 @@ RDF::RDF(unsigned int bins, float r_max, float r_min, bool normalize)
 
     // Construct the Histogram object that will be used to keep track of counts of bond distances found.
     BHAxes axes;
-    axes.push_back(std::make_shared<util::RegularAxis>(bins, r_min, r_max));
+    axes.push_back(util::RegularAxis(bins, r_min, r_max));
     m_histogram = BondHistogram(axes);
     m_local_histograms = BondHistogram::ThreadLocalHistogram(m_histogram);
 
@@ -76,9 +76,19 @@ void RDF::accumulate(const freud::locality::NeighborQuery* neighbor_query, const
                      unsigned int n_query_points, const freud::locality::NeighborList* nlist,
                      freud::locality::QueryArgs qargs)
 {
+    // The RDF is symmetric in the two points of a bond, so if the points are
+    // queried against themselves each pair only needs to be found once and
+    // counted in both directions.
+    const bool unique_pairs
+        = freud::locality::canFindUniquePairs(neighbor_query, query_points, n_query_points, qargs, nlist);
+    qargs.unique_pairs = unique_pairs;
     accumulateGeneral(neighbor_query, query_points, n_query_points, nlist, qargs,
                       [=](const freud::locality::NeighborBond& neighbor_bond) {
-                          m_local_histograms(neighbor_bond.distance);
+                          const unsigned int weight
+                              = (unique_pairs && neighbor_bond.query_point_idx != neighbor_bond.point_idx)
+                              ? 2
+                              : 1;
+                          m_local_histograms(neighbor_bond.distance, util::Weight<unsigned int>(weight));
                       });
 }
 
@@ -75,9 +75,9 @@ void AngularSeparationNeighbor::compute(const locality::NeighborQuery* nq, const
         {
             quat<float> q = orientations[i];
 
-            for (; bond < tot_num_neigh && m_nlist.getNeighbors()(bond, 0) == i; ++bond)
+            for (; bond < m_nlist.find_first_index(i + 1); ++bond)
             {
-                const size_t j(m_nlist.getNeighbors()(bond, 1));
+                const size_t j(m_nlist.getPointIndices()[bond]);
                 quat<float> query_q = query_orientations[j];
 
                 float theta = computeMinSeparationAngle(q, query_q, equiv_orientations, n_equiv_orientations);
@@ -93,6 +93,7 @@ void AngularSeparationGlobal::compute(const quat<float>* global_orientations, un
                                       unsigned int n_equiv_orientations)
 {
     m_angles.prepare({n_points, n_global});
+    const auto angles = m_angles.view<2>();
 
     util::forLoopWrapper(0, n_points, [=](size_t begin, size_t end) {
         for (size_t i = begin; i < end; ++i)
@@ -103,7 +104,7 @@ void AngularSeparationGlobal::compute(const quat<float>* global_orientations, un
                 quat<float> global_q = global_orientations[j];
                 float theta
                     = computeMinSeparationAngle(q, global_q, equiv_orientations, n_equiv_orientations);
-                m_angles(i, j) = theta;
+                angles(i, j) = theta;
             }
         }
     });
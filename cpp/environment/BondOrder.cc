@@ -49,8 +49,8 @@ BondOrder::BondOrder(unsigned int n_bins_theta, unsigned int n_bins_phi, BondOrd
         }
     }
     BHAxes axes;
-    axes.push_back(std::make_shared<util::RegularAxis>(n_bins_theta, 0, constants::TWO_PI));
-    axes.push_back(std::make_shared<util::RegularAxis>(n_bins_phi, 0, M_PI));
+    axes.push_back(util::RegularAxis(n_bins_theta, 0, constants::TWO_PI));
+    axes.push_back(util::RegularAxis(n_bins_phi, 0, M_PI));
     m_histogram = BondHistogram(axes);
 
     m_local_histograms = BondHistogram::ThreadLocalHistogram(m_histogram);
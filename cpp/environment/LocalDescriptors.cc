@@ -45,11 +45,11 @@ void LocalDescriptors::compute(const locality::NeighborQuery* nq, const vec3<flo
             {
                 util::ManagedArray<float> inertiaTensor = util::ManagedArray<float>({3, 3});
 
-                for (size_t bond_copy(bond); bond_copy < m_nlist.getNumBonds()
-                     && m_nlist.getNeighbors()(bond_copy, 0) == i && neighbor_count < max_num_neighbors;
+                for (size_t bond_copy(bond);
+                     bond_copy < m_nlist.find_first_index(i + 1) && neighbor_count < max_num_neighbors;
                      ++bond_copy, ++neighbor_count)
                 {
-                    const size_t j(m_nlist.getNeighbors()(bond_copy, 1));
+                    const size_t j(m_nlist.getPointIndices()[bond_copy]);
                     const vec3<float> r_ij(bondVector(locality::NeighborBond(i, j), nq, query_points));
                     const float r_sq(dot(r_ij, r_ij));
 
@@ -97,12 +97,11 @@ void LocalDescriptors::compute(const locality::NeighborQuery* nq, const vec3<flo
             }
 
             neighbor_count = 0;
-            for (; bond < m_nlist.getNumBonds() && m_nlist.getNeighbors()(bond, 0) == i
-                 && neighbor_count < max_num_neighbors;
+            for (; bond < m_nlist.find_first_index(i + 1) && neighbor_count < max_num_neighbors;
                  ++bond, ++neighbor_count)
             {
                 const unsigned int sphCount(bond * getSphWidth());
-                const size_t j(m_nlist.getNeighbors()(bond, 1));
+                const size_t j(m_nlist.getPointIndices()[bond]);
                 const vec3<float> r_ij(bondVector(locality::NeighborBond(i, j), nq, query_points));
                 const float r_sq(dot(r_ij, r_ij));
                 const vec3<float> bond_ij(dot(rotation_0, r_ij), dot(rotation_1, r_ij),
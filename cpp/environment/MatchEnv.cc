@@ -499,17 +499,17 @@ MatchEnv::~MatchEnv() {}
 EnvironmentCluster::~EnvironmentCluster() {}
 
 Environment MatchEnv::buildEnv(const freud::locality::NeighborQuery* nq,
-                               const freud::locality::NeighborList* nlist, size_t num_bonds, size_t& bond,
-                               unsigned int i, unsigned int env_ind)
+                               const freud::locality::NeighborList* nlist, size_t& bond, unsigned int i,
+                               unsigned int env_ind)
 {
     Environment ei = Environment();
     // set the environment index equal to the particle index
     ei.env_ind = env_ind;
 
-    for (; bond < num_bonds && nlist->getNeighbors()(bond, 0) == i; ++bond)
+    for (; bond < nlist->find_first_index(i + 1); ++bond)
     {
         // compute vec{r} between the two particles
-        const size_t j(nlist->getNeighbors()(bond, 1));
+        const size_t j(nlist->getPointIndices()[bond]);
         if (i != j)
         {
             vec3<float> delta(bondVector(locality::NeighborBond(i, j), nq, nq->getPoints()));
@@ -539,7 +539,6 @@ void EnvironmentCluster::compute(const freud::locality::NeighborQuery* nq,
     nlist.validate(Np, Np);
     env_nlist.validate(Np, Np);
     size_t env_bond(0);
-    const size_t env_num_bonds(env_nlist.getNumBonds());
 
     // create a disjoint set where all particles belong in their own cluster
     EnvDisjointSet dj(Np);
@@ -550,7 +549,7 @@ void EnvironmentCluster::compute(const freud::locality::NeighborQuery* nq,
     // if you don't do this, things will get screwy.
     for (unsigned int i = 0; i < Np; i++)
     {
-        Environment ei = buildEnv(nq, &env_nlist, env_num_bonds, env_bond, i, i);
+        Environment ei = buildEnv(nq, &env_nlist, env_bond, i, i);
         dj.s.push_back(ei);
         dj.m_max_num_neigh = std::max(dj.m_max_num_neigh, ei.num_vecs);
         ;
@@ -566,9 +565,9 @@ void EnvironmentCluster::compute(const freud::locality::NeighborQuery* nq,
         if (global == false)
         {
             // loop over the neighbors
-            for (; bond < nlist.getNumBonds() && nlist.getNeighbors()(bond, 0) == i; ++bond)
+            for (; bond < nlist.find_first_index(i + 1); ++bond)
             {
-                const size_t j(nlist.getNeighbors()(bond, 1));
+                const size_t j(nlist.getPointIndices()[bond]);
                 std::pair<rotmat3<float>, BiMap<unsigned int, unsigned int>> mapping
                     = isSimilar(dj.s[i], dj.s[j], m_threshold_sq, registration);
                 rotmat3<float> rotation = mapping.first;
@@ -713,7 +712,6 @@ void EnvironmentMotifMatch::compute(const freud::locality::NeighborQuery* nq,
     dj.s.push_back(e0);
 
     size_t bond(0);
-    const size_t num_bonds(nlist.getNumBonds());
 
     m_matches.prepare(Np);
 
@@ -724,7 +722,7 @@ void EnvironmentMotifMatch::compute(const freud::locality::NeighborQuery* nq,
     for (unsigned int i = 0; i < Np; i++)
     {
         unsigned int dummy = i + 1;
-        Environment ei = buildEnv(nq, &nlist, num_bonds, bond, i, dummy);
+        Environment ei = buildEnv(nq, &nlist, bond, i, dummy);
         dj.s.push_back(ei);
 
         // if the environment matches e0, merge it into the e0 environment set
@@ -790,7 +788,6 @@ void EnvironmentRMSDMinimizer::compute(const freud::locality::NeighborQuery* nq,
     dj.s.push_back(e0);
 
     size_t bond(0);
-    const size_t num_bonds(nlist.getNumBonds());
 
     m_rmsds.prepare(Np);
 
@@ -801,7 +798,7 @@ void EnvironmentRMSDMinimizer::compute(const freud::locality::NeighborQuery* nq,
     for (unsigned int i = 0; i < Np; i++)
     {
         unsigned int dummy = i + 1;
-        Environment ei = buildEnv(nq, &nlist, num_bonds, bond, i, dummy);
+        Environment ei = buildEnv(nq, &nlist, bond, i, dummy);
         dj.s.push_back(ei);
 
         // if the environment matches e0, merge it into the e0 environment set
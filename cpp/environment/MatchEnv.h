@@ -207,7 +207,7 @@ public:
     //! Construct and return a local environment surrounding the particle indexed by i. Set the environment
     //! index to env_ind.
     Environment buildEnv(const freud::locality::NeighborQuery* nq, const freud::locality::NeighborList* nlist,
-                         size_t num_bonds, size_t& bond, unsigned int i, unsigned int env_ind);
+                         size_t& bond, unsigned int i, unsigned int env_ind);
 
     //! Returns the entire Np by m_num_neighbors by 3 matrix of all environments for all particles
     const util::ManagedArray<vec3<float>>& getPointEnvironments()
@@ -326,6 +326,32 @@ inline bool overlap(const AABB& a, const AABBSphere& b)
 #endif
 }
 
+//! Compute the squared distance from a point to an AABB
+/*! \param a AABB
+    \param point Point
+    \returns the squared distance from point to the closest point of a, which is zero if a contains point
+*/
+inline float distanceSquared(const AABB& a, const vec3<float>& point)
+{
+#if defined(__SSE__)
+    __m128 point_v = sse_load_vec3_float(point);
+    __m128 dr_v = _mm_sub_ps(_mm_min_ps(_mm_max_ps(point_v, a.lower_v), a.upper_v), point_v);
+    __m128 dr2_v = _mm_mul_ps(dr_v, dr_v);
+    __m128 shuf = _mm_shuffle_ps(dr2_v, dr2_v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(dr2_v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+
+#else
+    vec3<float> dr = vec3<float>(std::min(std::max(point.x, a.lower.x), a.upper.x) - point.x,
+                                 std::min(std::max(point.y, a.lower.y), a.upper.y) - point.y,
+                                 std::min(std::max(point.z, a.lower.z), a.upper.z) - point.z);
+    return dot(dr, dr);
+
+#endif
+}
+
 //! Check if one AABB contains another
 /*! \param a First AABB
     \param b Second AABB
@@ -2,14 +2,38 @@
 // This file is from the freud project, released under the BSD 3-Clause License.
 
 #include <algorithm>
+#include <functional>
 #include <stdexcept>
+#include <unordered_set>
 
 #include "AABBQuery.h"
+#include "NeighborHeap.h"
+#include "utils.h"
 
 namespace freud { namespace locality {
 
+namespace {
+//! Initial capacity of the queue of nodes to search for nearest neighbors.
+const unsigned int NODE_QUEUE_RESERVE = 64;
+
+//! A node of the tree to search for an image of the query point.
+struct NodeDistance
+{
+    NodeDistance(float distance_sq, unsigned int node) : distance_sq(distance_sq), node(node) {}
+
+    //! Order nodes by distance to search the closest one first.
+    bool operator>(const NodeDistance& other) const
+    {
+        return distance_sq > other.distance_sq;
+    }
+
+    float distance_sq; //!< Squared distance from the image of the query point to the node.
+    unsigned int node; //!< Index of the node.
+};
+}; // namespace
+
 AABBQuery::AABBQuery(const box::Box& box, const vec3<float>* points, unsigned int n_points)
-    : NeighborQuery(box, points, n_points)
+    : NeighborQuery(box, points, n_points), m_rebuild_threshold(1.5), m_built_area(0), m_num_builds(0)
 {
     // Allocate memory and create image vectors
     setupTree(m_n_points);
@@ -32,8 +56,7 @@ AABBQuery::querySingle(const vec3<float> query_point, unsigned int query_point_i
     else if (args.mode == QueryArgs::nearest)
     {
         return std::make_shared<AABBQueryIterator>(this, query_point, query_point_idx, args.num_neighbors,
-                                                   args.r_guess, args.r_max, args.r_min, args.scale,
-                                                   args.exclude_ii);
+                                                   args.r_max, args.r_min, args.exclude_ii);
     }
     else
     {
@@ -48,85 +71,222 @@ void AABBQuery::setupTree(unsigned int Np)
 
 void AABBQuery::buildTree(const vec3<float>* points, unsigned int Np)
 {
-    // Construct a point AABB for each point
-    for (unsigned int i = 0; i < Np; ++i)
-    {
-        // Make a point AABB
-        vec3<float> my_pos(points[i]);
-        if (m_box.is2D())
-            my_pos.z = 0;
-        m_aabbs[i] = AABB(my_pos, i);
-    }
+    computeAABBs(points, Np);
 
     // Call the tree build routine, one tree per type
     m_aabb_tree.buildTree(m_aabbs.data(), Np);
+    m_built_area = m_aabb_tree.getTotalArea();
+    ++m_num_builds;
 }
 
-void AABBIterator::updateImageVectors(float r_max, bool _check_r_max)
+void AABBQuery::computeAABBs(const vec3<float>* points, unsigned int Np)
 {
-    box::Box box = m_neighbor_query->getBox();
-    vec3<float> nearest_plane_distance = box.getNearestPlaneDistance();
-    vec3<bool> periodic = box.getPeriodic();
-    if (_check_r_max)
-    {
-        if ((periodic.x && nearest_plane_distance.x <= r_max * 2.0)
-            || (periodic.y && nearest_plane_distance.y <= r_max * 2.0)
-            || (!box.is2D() && periodic.z && nearest_plane_distance.z <= r_max * 2.0))
+    util::forLoopWrapper(0, Np, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
         {
-            throw std::runtime_error("The AABBQuery r_max is too large for this box.");
+            // Make a point AABB
+            vec3<float> my_pos(points[i]);
+            if (m_box.is2D())
+                my_pos.z = 0;
+            m_aabbs[i] = AABB(my_pos, static_cast<unsigned int>(i));
         }
-    }
+    });
+}
+
+void AABBQuery::update(const vec3<float>* points, unsigned int n_points)
+{
+    const unsigned int old_n_points = m_n_points;
+    setPoints(points, n_points);
 
-    // Now compute the image vectors
-    // Each dimension increases by one power of 3
-    unsigned int n_dim_periodic = (unsigned int) (periodic.x + periodic.y + (!box.is2D()) * periodic.z);
-    m_n_images = 1;
-    for (unsigned int dim = 0; dim < n_dim_periodic; ++dim)
+    if (n_points != old_n_points)
     {
-        m_n_images *= 3;
+        setupTree(n_points);
+        buildTree(points, n_points);
+        return;
     }
 
-    // Reallocate memory if necessary
-    if (m_n_images > m_image_list.size())
+    // refit the existing tree and only rebuild it once it has degraded too much
+    computeAABBs(points, n_points);
+    m_aabb_tree.refit(m_aabbs.data());
+    if (m_aabb_tree.getTotalArea() > m_rebuild_threshold * m_built_area)
     {
-        m_image_list.resize(m_n_images);
+        buildTree(points, n_points);
     }
+}
 
-    vec3<float> latt_a = vec3<float>(box.getLatticeVector(0));
-    vec3<float> latt_b = vec3<float>(box.getLatticeVector(1));
-    vec3<float> latt_c = vec3<float>(0.0, 0.0, 0.0);
-    if (!box.is2D())
+void AABBQuery::queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                           QueryArgs args, std::vector<NeighborBond>& bonds) const
+{
+    this->validateQueryArgs(args);
+    if (args.mode == QueryArgs::ball)
     {
-        latt_c = vec3<float>(box.getLatticeVector(2));
+        queryBallBatch(query_points, begin, end, args, bonds);
     }
+    else
+    {
+        NeighborQuery::queryBatch(query_points, begin, end, args, bonds);
+    }
+}
+
+void AABBQuery::queryBallBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                               const QueryArgs& args, std::vector<NeighborBond>& bonds) const
+{
+    const float r_max_sq = args.r_max * args.r_max;
+    const float r_min_sq = args.r_min * args.r_min;
+    const bool is2D = m_box.is2D();
 
-    // There is always at least 1 image, which we put as our first thing to look at
-    m_image_list[0] = vec3<float>(0.0, 0.0, 0.0);
+    checkRMax(args.r_max);
+    std::vector<vec3<float>> image_list;
+    const unsigned int n_nodes = m_aabb_tree.getNumNodes();
+    float leaf_r_sq[NODE_CAPACITY];
 
-    // Iterate over all other combinations of images
-    unsigned int n_images = 1;
-    for (int i = -1; i <= 1 && n_images < m_n_images; ++i)
+    for (unsigned int i = begin; i < end; ++i)
     {
-        for (int j = -1; j <= 1 && n_images < m_n_images; ++j)
+        // Read in the position of current point
+        vec3<float> pos_i(query_points[i]);
+        if (is2D)
         {
-            for (int k = -1; k <= 1 && n_images < m_n_images; ++k)
+            pos_i.z = 0;
+        }
+
+        // Loop over the image vectors whose ball can overlap the box
+        const unsigned int n_images = computeImageVectors(pos_i, args.r_max, image_list);
+        for (unsigned int cur_image = 0; cur_image < n_images; ++cur_image)
+        {
+            // Make an AABB for the image of this point
+            const vec3<float> pos_i_image = pos_i + image_list[cur_image];
+            const AABBSphere asphere(pos_i_image, args.r_max);
+
+            // Stackless traversal of the tree
+            for (unsigned int cur_node_idx = 0; cur_node_idx < n_nodes; ++cur_node_idx)
             {
-                if (!(i == 0 && j == 0 && k == 0))
+                const AABBNode& node = m_aabb_tree.getNode(cur_node_idx);
+                if (!overlap(node.aabb, asphere))
                 {
-                    // Skip any periodic images if we don't have periodicity
-                    if (i != 0 && !periodic.x)
-                        continue;
-                    if (j != 0 && !periodic.y)
-                        continue;
-                    if (k != 0 && (box.is2D() || !periodic.z))
-                        continue;
-
-                    m_image_list[n_images] = float(i) * latt_a + float(j) * latt_b + float(k) * latt_c;
-                    ++n_images;
+                    // Skip ahead
+                    cur_node_idx += node.skip;
+                    continue;
                 }
+
+                if (m_aabb_tree.isNodeLeaf(cur_node_idx))
+                {
+                    unsigned int hits
+                        = leafParticlesInShell(node, pos_i_image, r_min_sq, r_max_sq, leaf_r_sq);
+                    for (unsigned int cur_ref_p = 0; hits != 0; ++cur_ref_p, hits >>= 1)
+                    {
+                        if (!(hits & 1))
+                        {
+                            continue;
+                        }
+
+                        // Neighbor j
+                        const unsigned int j = node.particle_tags[cur_ref_p];
+
+                        // Skip ii matches immediately if requested.
+                        if (args.exclude_ii && i == j)
+                        {
+                            continue;
+                        }
+
+                        // Each unique pair is found by its lower index.
+                        if (args.unique_pairs && j < i)
+                        {
+                            continue;
+                        }
+
+                        bonds.emplace_back(i, j, std::sqrt(leaf_r_sq[cur_ref_p]));
+                    }
+                }
+            }
+        }
+    }
+}
+
+unsigned int AABBQuery::computeImageVectors(const vec3<float>& query_point, float r_max,
+                                            std::vector<vec3<float>>& image_list) const
+{
+    // A ball around an image of the query point can only contain points if it
+    // overlaps the box, which requires it to reach each slab of the box
+    // between opposite faces. The distance of the image shifted by +1 (-1)
+    // lattice vectors to its slab is the fractional distance of the query
+    // point to the lower (upper) face times the distance between the faces.
+    const vec3<float> frac = m_box.makeFractional(query_point);
+    const vec3<float> nearest_plane_distance = m_box.getNearestPlaneDistance();
+    const vec3<bool> periodic = m_box.getPeriodic();
+    const bool is_periodic[3] = {periodic.x, periodic.y, !m_box.is2D() && periodic.z};
+    const float lower_distance[3] = {frac.x * nearest_plane_distance.x, frac.y * nearest_plane_distance.y,
+                                     frac.z * nearest_plane_distance.z};
+    const float upper_distance[3]
+        = {(1 - frac.x) * nearest_plane_distance.x, (1 - frac.y) * nearest_plane_distance.y,
+           (1 - frac.z) * nearest_plane_distance.z};
+
+    int offsets[3][3];
+    unsigned int n_offsets[3];
+    for (unsigned int dim = 0; dim < 3; ++dim)
+    {
+        offsets[dim][0] = 0;
+        n_offsets[dim] = 1;
+        if (is_periodic[dim] && lower_distance[dim] < r_max)
+        {
+            offsets[dim][n_offsets[dim]++] = 1;
+        }
+        if (is_periodic[dim] && upper_distance[dim] < r_max)
+        {
+            offsets[dim][n_offsets[dim]++] = -1;
+        }
+    }
+
+    const unsigned int n_images = n_offsets[0] * n_offsets[1] * n_offsets[2];
+    if (n_images > image_list.size())
+    {
+        image_list.resize(n_images);
+    }
+
+    const vec3<float> latt_a = vec3<float>(m_box.getLatticeVector(0));
+    const vec3<float> latt_b = vec3<float>(m_box.getLatticeVector(1));
+    const vec3<float> latt_c = m_box.is2D() ? vec3<float>(0, 0, 0) : vec3<float>(m_box.getLatticeVector(2));
+
+    // The first image is always the query point itself.
+    unsigned int cur_image = 0;
+    for (unsigned int i = 0; i < n_offsets[0]; ++i)
+    {
+        for (unsigned int j = 0; j < n_offsets[1]; ++j)
+        {
+            for (unsigned int k = 0; k < n_offsets[2]; ++k)
+            {
+                image_list[cur_image] = float(offsets[0][i]) * latt_a + float(offsets[1][j]) * latt_b
+                    + float(offsets[2][k]) * latt_c;
+                ++cur_image;
             }
         }
     }
+    return n_images;
+}
+
+void AABBQuery::checkRMax(float r_max) const
+{
+    const vec3<float> nearest_plane_distance = m_box.getNearestPlaneDistance();
+    const vec3<bool> periodic = m_box.getPeriodic();
+    if ((periodic.x && nearest_plane_distance.x <= r_max * 2.0)
+        || (periodic.y && nearest_plane_distance.y <= r_max * 2.0)
+        || (!m_box.is2D() && periodic.z && nearest_plane_distance.z <= r_max * 2.0))
+    {
+        throw std::runtime_error("The AABBQuery r_max is too large for this box.");
+    }
+}
+
+void AABBIterator::updateImageVectors(float r_max, bool _check_r_max)
+{
+    if (_check_r_max)
+    {
+        m_aabb_query->checkRMax(r_max);
+    }
+    vec3<float> query_point(m_query_point);
+    if (m_neighbor_query->getBox().is2D())
+    {
+        query_point.z = 0;
+    }
+    m_n_images = m_aabb_query->computeImageVectors(query_point, r_max, m_image_list);
 }
 
 NeighborBond AABBQueryBallIterator::next()
@@ -155,36 +315,34 @@ NeighborBond AABBQueryBallIterator::next()
             {
                 if (m_aabb_query->m_aabb_tree.isNodeLeaf(cur_node_idx))
                 {
-                    while (cur_ref_p < m_aabb_query->m_aabb_tree.getNodeNumParticles(cur_node_idx))
+                    const AABBNode& node = m_aabb_query->m_aabb_tree.getNode(cur_node_idx);
+
+                    // Test all particles of the leaf when entering it.
+                    if (cur_ref_p == 0)
                     {
-                        // Neighbor j
-                        const unsigned int j
-                            = m_aabb_query->m_aabb_tree.getNodeParticleTag(cur_node_idx, cur_ref_p);
-                        // Increment before possible return.
-                        cur_ref_p++;
+                        m_leaf_hits
+                            = leafParticlesInShell(node, pos_i_image, r_min_sq, r_max_sq, m_leaf_r_sq);
+                    }
 
-                        // Skip ii matches immediately if requested.
-                        if (m_exclude_ii && m_query_point_idx == j)
+                    while (cur_ref_p < node.num_particles)
+                    {
+                        // Increment before possible return.
+                        const unsigned int leaf_idx = cur_ref_p++;
+                        if (!(m_leaf_hits & (1u << leaf_idx)))
                         {
                             continue;
                         }
 
-                        // Read in the position of j
-                        vec3<float> pos_j((*m_neighbor_query)[j]);
-                        if (m_neighbor_query->getBox().is2D())
-                        {
-                            pos_j.z = 0;
-                        }
-
-                        // Compute distance
-                        const vec3<float> r_ij = pos_j - pos_i_image;
-                        const float r_sq = dot(r_ij, r_ij);
+                        // Neighbor j
+                        const unsigned int j = node.particle_tags[leaf_idx];
 
-                        // Check ii exclusion before including the pair.
-                        if (r_sq < r_max_sq && r_sq >= r_min_sq)
+                        // Skip ii matches immediately if requested.
+                        if (m_exclude_ii && m_query_point_idx == j)
                         {
-                            return NeighborBond(m_query_point_idx, j, std::sqrt(r_sq));
+                            continue;
                         }
+
+                        return NeighborBond(m_query_point_idx, j, std::sqrt(m_leaf_r_sq[leaf_idx]));
                     }
                 }
             }
@@ -206,124 +364,152 @@ NeighborBond AABBQueryBallIterator::next()
 
 NeighborBond AABBQueryIterator::next()
 {
-    vec3<float> plane_distance = m_neighbor_query->getBox().getNearestPlaneDistance();
+    // This iterator is not truly lazy; it finds all neighbors the first time
+    // next is called and then returns them one by one.
+    if (!m_searched)
+    {
+        findNeighbors();
+        m_searched = true;
+    }
+
+    if (m_count < m_current_neighbors.size())
+    {
+        return m_current_neighbors[m_count++];
+    }
+
+    m_finished = true;
+    return NeighborQueryIterator::ITERATOR_TERMINATOR;
+}
+
+void AABBQueryIterator::findNeighbors()
+{
+    const box::Box& box = m_neighbor_query->getBox();
+    const AABBTree& tree = m_aabb_query->m_aabb_tree;
+
+    // Two periodic images of a point are at least the smallest distance
+    // between opposite faces of the box apart, so they can only both be
+    // within a cutoff of more than half of that distance.
+    const vec3<float> plane_distance = box.getNearestPlaneDistance();
     float min_plane_distance = std::min(plane_distance.x, plane_distance.y);
-    float max_plane_distance = std::max(plane_distance.x, plane_distance.y);
-    if (!m_neighbor_query->getBox().is2D())
+    if (!box.is2D())
     {
         min_plane_distance = std::min(min_plane_distance, plane_distance.z);
-        max_plane_distance = std::max(max_plane_distance, plane_distance.z);
     }
 
-    // This iterator is not truly lazy; because it needs to get possible
-    // neighbors and sort them to find the actual ones, it computes and caches
-    // them and then returns them one-by-one. This check ensures that we only
-    // search for new neighbors the first time next is called.
-    if (!m_current_neighbors.size())
+    vec3<float> pos_i(m_query_point);
+    if (box.is2D())
     {
-        // Continually perform ball queries until the termination conditions are met.
-        while (true)
+        pos_i.z = 0;
+    }
+
+    NeighborHeap heap(m_num_neighbors);
+    std::vector<NodeDistance> nodes;
+    nodes.reserve(NODE_QUEUE_RESERVE);
+    std::unordered_set<unsigned int> below_r_min;
+    const float r_min_sq = m_r_min * m_r_min;
+    float leaf_r_sq[NODE_CAPACITY];
+    float cutoff = m_r_max;
+    float cutoff_sq = cutoff * cutoff;
+
+    // Search the tree best first for one image of the query point, shrinking
+    // the cutoff as closer neighbors are found. Since points appear only once
+    // in the tree, a point can only be found twice by searching several images.
+    auto search_image = [&](const vec3<float>& pos_i_image, bool primary_image) {
+        nodes.clear();
+        nodes.push_back(NodeDistance(distanceSquared(tree.getNodeAABB(0), pos_i_image), 0));
+        while (!nodes.empty() && nodes.front().distance_sq < cutoff_sq)
         {
-            // Perform a ball query to get neighbors. To ensure that we allow
-            // ball queries to exceed their normal boundaries, we pass false as
-            // the _check_r_max. We also can't depend on the ball query for
-            // r_min filtering because we're querying beyond the normally safe
-            // bounds, so we have to do it in this class.
-            m_current_neighbors.clear();
-            m_all_distances.clear();
-            m_query_points_below_r_min.clear();
-            std::shared_ptr<NeighborQueryPerPointIterator> ball_it = std::make_shared<AABBQueryBallIterator>(
-                static_cast<const AABBQuery*>(m_neighbor_query), m_query_point, m_query_point_idx,
-                std::min(m_r_cur, m_r_max), 0, m_exclude_ii, false);
-            while (!ball_it->end())
-            {
-                NeighborBond nb = ball_it->next();
-                if (nb == NeighborQueryIterator::ITERATOR_TERMINATOR)
-                    continue;
+            std::pop_heap(nodes.begin(), nodes.end(), std::greater<NodeDistance>());
+            unsigned int cur_node_idx = nodes.back().node;
+            nodes.pop_back();
 
-                if (!m_exclude_ii || m_query_point_idx != nb.point_idx)
+            // Descend towards the closest leaf, queueing the farther children.
+            bool reached_leaf = true;
+            while (!tree.isNodeLeaf(cur_node_idx))
+            {
+                const AABBNode& node = tree.getNode(cur_node_idx);
+                NodeDistance closer(distanceSquared(tree.getNodeAABB(node.left), pos_i_image), node.left);
+                NodeDistance farther(distanceSquared(tree.getNodeAABB(node.right), pos_i_image), node.right);
+                if (closer > farther)
                 {
-                    nb.query_point_idx = m_query_point_idx;
-                    // If we've expanded our search radius beyond safe
-                    // distance, use the map instead of the vector.
-                    if (m_search_extended)
-                    {
-                        if (!m_all_distances.count(nb.point_idx)
-                            || m_all_distances[nb.point_idx] > nb.distance)
-                        {
-                            m_all_distances[nb.point_idx] = nb.distance;
-                            if (nb.distance < m_r_min)
-                            {
-                                m_query_points_below_r_min.insert(nb.point_idx);
-                            }
-                        }
-                    }
-                    else
-                    {
-                        if (nb.distance >= m_r_min)
-                            m_current_neighbors.emplace_back(nb);
-                    }
+                    std::swap(closer, farther);
+                }
+                if (farther.distance_sq < cutoff_sq)
+                {
+                    nodes.push_back(farther);
+                    std::push_heap(nodes.begin(), nodes.end(), std::greater<NodeDistance>());
                 }
+                if (closer.distance_sq >= cutoff_sq)
+                {
+                    reached_leaf = false;
+                    break;
+                }
+                cur_node_idx = closer.node;
             }
-
-            // Break if there are enough neighbors, or if we are querying beyond the limits of
-            // the periodic box.
-            m_r_cur *= m_scale;
-
-            if (m_current_neighbors.size() >= m_num_neighbors)
+            if (!reached_leaf)
             {
-                std::sort(m_current_neighbors.begin(), m_current_neighbors.end());
-                break;
+                continue;
             }
-            else if ((m_r_cur >= m_r_max) || (m_r_cur >= max_plane_distance)
-                     || ((m_all_distances.size() - m_query_points_below_r_min.size()) >= m_num_neighbors))
+
+            const AABBNode& node = tree.getNode(cur_node_idx);
+            unsigned int hits = leafParticlesInShell(node, pos_i_image, 0, cutoff_sq, leaf_r_sq);
+            for (unsigned int cur_ref_p = 0; hits != 0; ++cur_ref_p, hits >>= 1)
             {
-                // Once this condition is reached, either we found enough
-                // neighbors beyond the normal min_plane_distance
-                // condition or we conclude that there are not enough
-                // neighbors left in the system.
-                for (std::map<unsigned int, float>::const_iterator it(m_all_distances.begin());
-                     it != m_all_distances.end(); it++)
+                if (!(hits & 1))
+                {
+                    continue;
+                }
+
+                const unsigned int j = node.particle_tags[cur_ref_p];
+                if (m_exclude_ii && m_query_point_idx == j)
+                {
+                    continue;
+                }
+
+                // Points are excluded if their closest image is within r_min.
+                const bool images_in_range = (2 * cutoff > min_plane_distance);
+                if (leaf_r_sq[cur_ref_p] < r_min_sq)
                 {
-                    if (it->second >= m_r_min)
+                    if (images_in_range)
                     {
-                        m_current_neighbors.emplace_back(m_query_point_idx, it->first, it->second);
+                        below_r_min.insert(j);
+                        heap.erase(j);
                     }
+                    continue;
+                }
+
+                const NeighborBond bond(m_query_point_idx, j, std::sqrt(leaf_r_sq[cur_ref_p]));
+                if (primary_image || !images_in_range)
+                {
+                    heap.insert(bond);
+                }
+                else if (!below_r_min.count(j))
+                {
+                    heap.insertClosestImage(bond);
+                }
+
+                // Only bonds closer than the k-th nearest neighbor can be among
+                // the nearest neighbors once k have been found.
+                if (heap.full() && heap.maxDistance() < cutoff)
+                {
+                    cutoff = heap.maxDistance();
+                    cutoff_sq = cutoff * cutoff;
                 }
-                std::sort(m_current_neighbors.begin(), m_current_neighbors.end());
-                break;
-            }
-            else if (m_r_cur > min_plane_distance / 2)
-            {
-                // If we have to go beyond the cutoff radius, we need to
-                // start tracking what particles are already in the set so
-                // that we can make sure that we find the closest image
-                // because we now run the risk of finding duplicates.
-                //
-                // We could make this marginally more efficient by checking
-                // whether we've exactly hit the limit, or if there's a
-                // rescaling that would let us try the exact limit once
-                // before going beyond the min plane distance.
-                m_search_extended = true;
             }
         }
-    }
-
-    // Now we return all the points found for the current point, stopping when
-    // any are beyond the maximum distance allowed.
-    while ((m_count < m_num_neighbors) && (m_count < m_current_neighbors.size()))
+    };
+
+    // The neighbors found around the query point itself usually bound the
+    // search tightly enough that few or no periodic images remain to be
+    // searched, so the images are only determined afterwards.
+    search_image(pos_i, true);
+    updateImageVectors(cutoff, false);
+    for (unsigned int cur_image = 1; cur_image < m_n_images; ++cur_image)
     {
-        m_count++;
-        if (m_current_neighbors[m_count - 1].distance > m_r_max)
-        {
-            m_finished = true;
-            return NeighborQueryIterator::ITERATOR_TERMINATOR;
-        }
-        return m_current_neighbors[m_count - 1];
+        search_image(pos_i + m_image_list[cur_image], false);
     }
 
-    m_finished = true;
-    return NeighborQueryIterator::ITERATOR_TERMINATOR;
+    heap.popSorted(m_current_neighbors);
 }
 
 }; }; // end namespace freud::locality
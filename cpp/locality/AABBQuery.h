@@ -5,9 +5,8 @@
 #define AABBQUERY_H
 
 #include <cmath>
-#include <map>
 #include <memory>
-#include <unordered_set>
+#include <stdexcept>
 #include <vector>
 
 #include "AABBTree.h"
@@ -49,55 +48,70 @@ public:
     virtual std::shared_ptr<NeighborQueryPerPointIterator>
     querySingle(const vec3<float> query_point, unsigned int query_point_idx, QueryArgs args) const;
 
-    AABBTree m_aabb_tree; //!< AABB tree of points
-
-protected:
-    //! Validate the combination of specified arguments.
-    /*! Add to parent function to account for the various arguments
-     *  specifically required for AABBQuery nearest neighbor queries.
+    //! Implementation of batched query for AABBQuery (see NeighborQuery.h for documentation).
+    virtual void queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                            QueryArgs args, std::vector<NeighborBond>& bonds) const;
+
+    //! Compute the periodic image vectors that must be searched for a given query point and cutoff.
+    /*! Only the images of the query point whose ball of radius r_max can
+     *  overlap the box are returned, so query points farther than r_max from
+     *  all faces of the box only need to search a single image.
+     *
+     *  \param query_point The query point.
+     *  \param r_max The query distance.
+     *  \param image_list Vector that is resized as needed and filled with the image vectors.
+     *
+     *  \return The number of image vectors to check.
      */
-    virtual void validateQueryArgs(QueryArgs& args) const
+    unsigned int computeImageVectors(const vec3<float>& query_point, float r_max,
+                                     std::vector<vec3<float>>& image_list) const;
+
+    //! Throw an error if r_max is too large for the box.
+    void checkRMax(float r_max) const;
+
+    //! Update the tree for new positions of the points
+    /*! The AABBs of the existing tree are refit to the new positions, which
+     *  is much cheaper than building a new tree when the points moved only
+     *  slightly. The tree is rebuilt if the number of points changed or if
+     *  the total surface area of the refit nodes exceeds the rebuild
+     *  threshold times the total surface area right after the last build.
+     *  Points that are wrapped through the box boundaries stretch their
+     *  nodes across the box and therefore quickly lead to a rebuild.
+     *
+     *  \param points The new point positions.
+     *  \param n_points The number of points.
+     */
+    void update(const vec3<float>* points, unsigned int n_points);
+
+    //! Get the ratio of refit to built tree area above which update rebuilds the tree
+    float getRebuildThreshold() const
     {
-        NeighborQuery::validateQueryArgs(args);
-        if (args.mode == QueryArgs::nearest)
+        return m_rebuild_threshold;
+    }
+
+    //! Set the ratio of refit to built tree area above which update rebuilds the tree
+    void setRebuildThreshold(float rebuild_threshold)
+    {
+        if (rebuild_threshold < 1)
         {
-            if (args.scale == QueryArgs::DEFAULT_SCALE)
-            {
-                args.scale = float(1.1);
-            }
-            else if (args.scale <= float(1.0))
-            {
-                throw std::runtime_error("The scale query argument must be greater than 1.");
-            }
-
-            if (args.r_guess == QueryArgs::DEFAULT_R_GUESS)
-            {
-                // By default, we assume a homogeneous system density and use
-                // that to estimate the distance we need to query. This
-                // calculation assumes a constant density of N/V, where N is
-                // the number of particles and V is the box volume, and it
-                // calculates the radius of a sphere that will contain the
-                // desired number of neighbors.
-                float r_guess = std::cbrtf((3.0 * static_cast<float>(args.num_neighbors) * m_box.getVolume())
-                                           / (4.0 * M_PI * static_cast<float>(getNPoints())));
-
-                // The upper bound is set by the minimum nearest plane distances.
-                vec3<float> nearest_plane_distance = m_box.getNearestPlaneDistance();
-                float min_plane_distance = std::min(nearest_plane_distance.x, nearest_plane_distance.y);
-                if (!m_box.is2D())
-                    min_plane_distance = std::min(min_plane_distance, nearest_plane_distance.z);
-
-                args.r_guess = std::min(r_guess, min_plane_distance / float(2.0));
-            }
-            if (args.r_guess > args.r_max)
-            {
-                // No need to search past the requested bounds even if requested.
-                args.r_guess = args.r_max;
-            }
+            throw std::invalid_argument("The rebuild threshold must be at least 1.");
         }
+        m_rebuild_threshold = rebuild_threshold;
+    }
+
+    //! Get the number of times the tree has been built
+    unsigned int getNumBuilds() const
+    {
+        return m_num_builds;
     }
 
+    AABBTree m_aabb_tree; //!< AABB tree of points
+
 private:
+    //! Find all neighbors of a block of query points within a ball without per-point iterators.
+    void queryBallBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                        const QueryArgs& args, std::vector<NeighborBond>& bonds) const;
+
     //! Driver for tree configuration
     void setupTree(unsigned int N);
 
@@ -107,7 +121,13 @@ private:
     //! Driver to build AABB trees
     void buildTree(const vec3<float>* points, unsigned int N);
 
+    //! Construct a point AABB for each point
+    void computeAABBs(const vec3<float>* points, unsigned int N);
+
     std::vector<AABB> m_aabbs; //!< Flat array of AABBs of all types
+    float m_rebuild_threshold; //!< Ratio of refit to built tree area above which update rebuilds the tree
+    float m_built_area;        //!< Total node area of the tree right after the last build
+    unsigned int m_num_builds; //!< Number of times the tree has been built
 };
 
 //! Parent class of AABB iterators that knows how to traverse general AABB tree structures.
@@ -135,19 +155,25 @@ protected:
 };
 
 //! Iterator that gets a specified number of nearest neighbors from AABB tree structures.
+/*! The tree is traversed best first: a priority queue holds the tree nodes
+ *  ordered by their distance to the query point, and the closest candidates
+ *  are kept in a bounded heap. The search ends as soon as the closest
+ *  remaining node is farther than the k-th nearest neighbor found, so the
+ *  exact nearest neighbors are found in a single traversal without an initial
+ *  guess of the search distance. The periodic images of the query point are
+ *  searched afterwards, and only those that can be closer to the box than the
+ *  k-th nearest neighbor found so far.
+ */
 class AABBQueryIterator : public AABBIterator
 {
 public:
     //! Constructor
     AABBQueryIterator(const AABBQuery* neighbor_query, const vec3<float> query_point,
-                      unsigned int query_point_idx, unsigned int num_neighbors, float r_guess, float r_max,
-                      float r_min, float scale, bool exclude_ii)
+                      unsigned int query_point_idx, unsigned int num_neighbors, float r_max, float r_min,
+                      bool exclude_ii)
         : AABBIterator(neighbor_query, query_point, query_point_idx, r_max, r_min, exclude_ii), m_count(0),
-          m_num_neighbors(num_neighbors), m_search_extended(false), m_r_cur(r_guess), m_scale(scale),
-          m_all_distances(), m_query_points_below_r_min()
-    {
-        updateImageVectors(0);
-    }
+          m_num_neighbors(num_neighbors), m_searched(false)
+    {}
 
     //! Empty Destructor
     virtual ~AABBQueryIterator() {}
@@ -156,18 +182,13 @@ public:
     virtual NeighborBond next();
 
 protected:
+    //! Find the nearest neighbors with a best first traversal of the tree.
+    void findNeighbors();
+
     unsigned int m_count;                          //!< Number of neighbors returned for the current point.
     unsigned int m_num_neighbors;                  //!< Number of nearest neighbors to find
     std::vector<NeighborBond> m_current_neighbors; //!< The current set of found neighbors.
-    float m_search_extended; //!< Flag to see whether we've gone past the safe cutoff distance and have to be
-                             //!< worried about finding duplicates.
-    float
-        m_r_cur; //!< Current search ball cutoff distance in use for the current particle (expands as needed).
-    float m_scale; //!< The amount to scale m_r by when the current ball is too small.
-    std::map<unsigned int, float> m_all_distances; //!< Hash map of minimum distances found for a given point,
-                                                   //!< used when searching beyond maximum safe AABB distance.
-    std::unordered_set<unsigned int> m_query_points_below_r_min; //!< The set of query_points that were too
-                                                                 //!< close based on the r_min threshold.
+    bool m_searched;                               //!< Whether the neighbors have been found.
 };
 
 //! Iterator that gets neighbors in a ball of size r_max using AABB tree structures.
@@ -179,7 +200,7 @@ public:
                           unsigned int query_point_idx, float r_max, float r_min, bool exclude_ii,
                           bool _check_r_max = true)
         : AABBIterator(neighbor_query, query_point, query_point_idx, r_max, r_min, exclude_ii), cur_image(0),
-          cur_node_idx(0), cur_ref_p(0)
+          cur_node_idx(0), cur_ref_p(0), m_leaf_hits(0)
     {
         updateImageVectors(m_r_max, _check_r_max);
     }
@@ -195,6 +216,8 @@ private:
     unsigned int cur_node_idx; //!< The current node in the tree.
     unsigned int
         cur_ref_p; //!< The current index into the reference particles in the current node of the tree.
+    unsigned int m_leaf_hits;         //!< Bitmask of the particles of the current leaf within the ball.
+    float m_leaf_r_sq[NODE_CAPACITY]; //!< Squared distances to the particles of the current leaf.
 };
 }; }; // end namespace freud::locality
 
@@ -4,12 +4,16 @@
 #ifndef AABB_TREE_H
 #define AABB_TREE_H
 
+#include <algorithm>
 #include <cstring>
 #include <stack>
+#include <stdexcept>
+#include <tbb/tbb.h>
 #include <vector>
 
 #include "AABB.h"
 #include "VectorMath.h"
+#include "utils.h"
 
 /*! \file AABBTree.h
     \brief AABBTree build and query methods
@@ -28,6 +32,7 @@ namespace freud { namespace locality {
 
 const unsigned int NODE_CAPACITY = 16;        //!< Maximum number of particles in a node
 const unsigned int INVALID_NODE = 0xffffffff; //!< Invalid node index sentinel
+const unsigned int BUILD_SERIAL_CUTOFF = 4096; //!< Number of particles below which nodes are built serially
 
 //! Node in an AABBTree
 /*! Stores data for a node in the AABB tree
@@ -40,6 +45,10 @@ struct CACHE_ALIGN AABBNode
         left = right = parent = INVALID_NODE;
         num_particles = 0;
         skip = 0;
+        for (unsigned int i = 0; i < NODE_CAPACITY; i++)
+        {
+            particle_x[i] = particle_y[i] = particle_z[i] = 0;
+        }
     }
 
     AABB aabb;           //!< The box bounding this node's volume
@@ -51,8 +60,101 @@ struct CACHE_ALIGN AABBNode
     unsigned int particles[NODE_CAPACITY];     //!< Indices of the particles contained in the node
     unsigned int particle_tags[NODE_CAPACITY]; //!< Corresponding particle tags for particles in node
     unsigned int num_particles;                //!< Number of particles contained in the node
+
+    float particle_x[NODE_CAPACITY]; //!< x coordinates of the particles contained in the node
+    float particle_y[NODE_CAPACITY]; //!< y coordinates of the particles contained in the node
+    float particle_z[NODE_CAPACITY]; //!< z coordinates of the particles contained in the node
+
+    //! Set the particle in a slot of a leaf node
+    /*! \param i Slot of the particle in the node
+        \param aabb AABB of the particle
+    */
+    inline void setParticlePosition(unsigned int i, const AABB& aabb)
+    {
+        const vec3<float> pos = aabb.getPosition();
+        particle_x[i] = pos.x;
+        particle_y[i] = pos.y;
+        particle_z[i] = pos.z;
+    }
 };
 
+//! Find the particles of a leaf node within a spherical shell around a point
+/*! \param node Leaf node to test
+    \param pos Center of the shell
+    \param r_min_sq Squared inner radius of the shell (inclusive)
+    \param r_max_sq Squared outer radius of the shell (exclusive)
+    \param r_sq Output array of NODE_CAPACITY squared distances from pos to the particles of the node
+    \returns Bitmask with bit i set if particle i of the node lies within the shell
+
+    The distances to all particles of the node are computed at once from the coordinates stored in the node,
+   using the widest vector instructions the code is compiled for. Unused slots of the node are masked out.
+*/
+inline unsigned int leafParticlesInShell(const AABBNode& node, const vec3<float>& pos, float r_min_sq,
+                                         float r_max_sq, float* r_sq)
+{
+    static_assert(NODE_CAPACITY < 32, "Leaf hits must fit in an unsigned int bitmask");
+    unsigned int hits = 0;
+
+#if defined(__AVX512F__)
+    static_assert(NODE_CAPACITY % 16 == 0, "NODE_CAPACITY must be a multiple of the AVX-512 width");
+    const __m512 x = _mm512_set1_ps(pos.x), y = _mm512_set1_ps(pos.y), z = _mm512_set1_ps(pos.z);
+    const __m512 r_min_sq_v = _mm512_set1_ps(r_min_sq), r_max_sq_v = _mm512_set1_ps(r_max_sq);
+    for (unsigned int i = 0; i < NODE_CAPACITY; i += 16)
+    {
+        const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(node.particle_x + i), x);
+        const __m512 dy = _mm512_sub_ps(_mm512_loadu_ps(node.particle_y + i), y);
+        const __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(node.particle_z + i), z);
+        const __m512 d = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)),
+                                       _mm512_mul_ps(dz, dz));
+        _mm512_storeu_ps(r_sq + i, d);
+        const __mmask16 in_shell = _mm512_cmp_ps_mask(d, r_max_sq_v, _CMP_LT_OQ)
+            & _mm512_cmp_ps_mask(d, r_min_sq_v, _CMP_GE_OQ);
+        hits |= static_cast<unsigned int>(in_shell) << i;
+    }
+#elif defined(__AVX__)
+    static_assert(NODE_CAPACITY % 8 == 0, "NODE_CAPACITY must be a multiple of the AVX width");
+    const __m256 x = _mm256_set1_ps(pos.x), y = _mm256_set1_ps(pos.y), z = _mm256_set1_ps(pos.z);
+    const __m256 r_min_sq_v = _mm256_set1_ps(r_min_sq), r_max_sq_v = _mm256_set1_ps(r_max_sq);
+    for (unsigned int i = 0; i < NODE_CAPACITY; i += 8)
+    {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(node.particle_x + i), x);
+        const __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(node.particle_y + i), y);
+        const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(node.particle_z + i), z);
+        const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                       _mm256_mul_ps(dz, dz));
+        _mm256_storeu_ps(r_sq + i, d);
+        const __m256 in_shell = _mm256_and_ps(_mm256_cmp_ps(d, r_max_sq_v, _CMP_LT_OQ),
+                                              _mm256_cmp_ps(d, r_min_sq_v, _CMP_GE_OQ));
+        hits |= static_cast<unsigned int>(_mm256_movemask_ps(in_shell)) << i;
+    }
+#elif defined(__SSE__)
+    static_assert(NODE_CAPACITY % 4 == 0, "NODE_CAPACITY must be a multiple of the SSE width");
+    const __m128 x = _mm_set1_ps(pos.x), y = _mm_set1_ps(pos.y), z = _mm_set1_ps(pos.z);
+    const __m128 r_min_sq_v = _mm_set1_ps(r_min_sq), r_max_sq_v = _mm_set1_ps(r_max_sq);
+    for (unsigned int i = 0; i < NODE_CAPACITY; i += 4)
+    {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(node.particle_x + i), x);
+        const __m128 dy = _mm_sub_ps(_mm_loadu_ps(node.particle_y + i), y);
+        const __m128 dz = _mm_sub_ps(_mm_loadu_ps(node.particle_z + i), z);
+        const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        _mm_storeu_ps(r_sq + i, d);
+        const __m128 in_shell = _mm_and_ps(_mm_cmplt_ps(d, r_max_sq_v), _mm_cmpge_ps(d, r_min_sq_v));
+        hits |= static_cast<unsigned int>(_mm_movemask_ps(in_shell)) << i;
+    }
+#else
+    for (unsigned int i = 0; i < NODE_CAPACITY; i++)
+    {
+        const vec3<float> r_ij(node.particle_x[i] - pos.x, node.particle_y[i] - pos.y,
+                               node.particle_z[i] - pos.z);
+        r_sq[i] = dot(r_ij, r_ij);
+        if (r_sq[i] < r_max_sq && r_sq[i] >= r_min_sq)
+            hits |= 1u << i;
+    }
+#endif
+
+    return hits & ((1u << node.num_particles) - 1);
+}
+
 //! AABB Tree
 /*! An AABBTree stores a binary tree of AABBs. A leaf node stores up to NODE_CAPACITY particles by index. The
    bounding box of a leaf node surrounds all the bounding boxes of its contained particles. Internal nodes
@@ -60,23 +162,30 @@ struct CACHE_ALIGN AABBNode
 
     - Query  : Search through the tree and build a list of all particles that intersect with the query AABB.
    Runs in O(log N) time
+    - Refit : Recompute the AABBs of all nodes for a new set of particle AABBs in parallel, keeping the tree
+   topology. Like update, the tree degrades as particles move away from their original neighbors, which
+   getTotalArea() can detect.
     - Update : Update the AABB for a selected particle. Updating works well only for small movements as the
    tree topology is left unchanged. Runs in O(log N) time. AABBs are not saved for all particles, so an update
    will only increase the volume of nodes. The tree should be rebuilt periodically instead of continually
    updated.
     - buildTree : build an efficiently arranged tree given a complete set of AABBs, one for each particle.
+   Sorts the particles along a Morton curve and builds the nodes in parallel.
 
     **Implementation details**
 
-    AABBTree stores all nodes in a flat array managed by std::vector. To easily locate particle leaf nodes for
-   update, a reverse mapping is stored to locate the leaf node containing a particle. m_root tracks the index
+    AABBTree stores all nodes in a flat, 32 byte aligned array allocated with posix_memalign. To easily
+   locate particle leaf nodes for update, a reverse mapping is stored to locate the leaf node containing a particle. m_root tracks the index
    of the root node as the tree is built. The nodes store the indices of their left and right children along
-   with their AABB. Nodes are allocated as needed with allocate(). With multiple particles per leaf node, the
-   total number of internal nodes needed is not known (but can be estimated) until build time.
-
-    For performance, no recursive calls are used. Instead, each function is either turned into a loop if it
-   uses tail recursion, or it uses a local stack to traverse the tree. The stack is cached between calls to
-   limit the amount of dynamic memory allocation.
+   with their AABB. Since every leaf but the last one is full, the total number of nodes is known before the
+   build and the node array is allocated once with reserveNodes(). Leaf nodes also store the coordinates of
+   their particles in structure of arrays form so that leafParticlesInShell() can test all of them with vector
+   instructions.
+
+    Queries do not use recursive calls. They visit the nodes in depth-first order in a single loop and use
+   the skip value of each node to jump past subtrees that do not overlap. Building and refitting are
+   recursive instead: buildNode and refitNode handle one subtree per call and process the two children of
+   large subtrees in parallel.
 */
 class AABBTree
 {
@@ -144,7 +253,13 @@ public:
     }
 
     //! Build a tree smartly from a list of AABBs
-    inline void buildTree(AABB* aabbs, unsigned int N);
+    inline void buildTree(const AABB* aabbs, unsigned int N);
+
+    //! Refit the node AABBs to a new list of AABBs without changing the tree topology
+    inline void refit(const AABB* aabbs);
+
+    //! Get the total surface area of all nodes, a measure of the quality of the tree
+    inline float getTotalArea() const;
 
     //! Find all particles that overlap with the query AABB
     inline unsigned int query(std::vector<unsigned int>& hits, const AABB& aabb) const;
@@ -236,15 +351,20 @@ private:
     //! Initialize the tree to hold N particles
     inline void init(unsigned int N);
 
+    //! Find the split of a range of Morton codes between two children
+    inline unsigned int findSplit(const std::vector<unsigned int>& codes, unsigned int start,
+                                  unsigned int len) const;
+
     //! Build a node of the tree recursively
-    inline unsigned int buildNode(AABB* aabbs, std::vector<unsigned int>& idx, unsigned int start,
-                                  unsigned int len, unsigned int parent);
+    inline void buildNode(const AABB* aabbs, const std::vector<unsigned int>& idx,
+                          const std::vector<unsigned int>& codes, unsigned int node, unsigned int start,
+                          unsigned int len, unsigned int parent);
 
-    //! Allocate a new node
-    inline unsigned int allocateNode();
+    //! Refit a node of the tree recursively
+    inline void refitNode(const AABB* aabbs, unsigned int node);
 
-    //! Update the skip value for a node
-    inline unsigned int updateSkip(unsigned int idx);
+    //! Make room for the given number of nodes
+    inline void reserveNodes(unsigned int num_nodes);
 };
 
 /*! \param N Number of particles to allocate space for
@@ -315,6 +435,13 @@ inline void AABBTree::update(unsigned int idx, const AABB& aabb)
     // find the node this particle is in
     unsigned int node_idx = m_mapping[idx];
 
+    // store its new position
+    for (unsigned int i = 0; i < m_nodes[node_idx].num_particles; i++)
+    {
+        if (m_nodes[node_idx].particles[i] == idx)
+            m_nodes[node_idx].setParticlePosition(i, aabb);
+    }
+
     // grow its AABB if needed
     if (!contains(m_nodes[node_idx].aabb, aabb))
     {
@@ -358,236 +485,269 @@ inline unsigned int AABBTree::height(unsigned int idx)
     return height;
 }
 
+/*! \param v Integer to expand, clamped to 10 bits
+    \returns The bits of v interleaved with two zero bits each, for use in a 30-bit Morton code
+*/
+inline unsigned int expandMortonBits(unsigned int v)
+{
+    v = std::min(v, 1023u);
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
 /*! \param aabbs List of AABBs for each particle (must be 32-byte aligned)
     \param N Number of AABBs in the list
 
-    Builds a balanced tree from a given list of AABBs for each particle. Data in \a aabbs will be modified
-   during the construction process.
+    Builds a tree from a given list of AABBs for each particle as a linear bounding volume hierarchy. The
+   centers of the AABBs are quantized to 30-bit Morton codes within their common bounding box and sorted
+   along the resulting space filling curve. Consecutive runs of NODE_CAPACITY particles in that order form
+   the leaves, and the internal nodes split their range where the highest differing bit of the Morton codes
+   changes, rounded to the nearest leaf boundary. Both the sort and the recursive construction of the
+   internal nodes run in parallel.
+
+    Because every split falls on a leaf boundary, a subtree holding len particles always has
+   2*ceil(len/NODE_CAPACITY)-1 nodes. The nodes are therefore written directly to their final positions in
+   the depth first order required by the stackless traversal in query(), without any synchronization.
 */
-inline void AABBTree::buildTree(AABB* aabbs, unsigned int N)
+inline void AABBTree::buildTree(const AABB* aabbs, unsigned int N)
 {
     init(N);
+    if (N == 0)
+        return;
+
+    // find the bounding box of all AABB centers
+    const AABB bounds = tbb::parallel_reduce(
+        tbb::blocked_range<unsigned int>(0, N), AABB(aabbs[0].getPosition(), 0u),
+        [aabbs](const tbb::blocked_range<unsigned int>& r, const AABB& init) {
+            AABB bounds(init);
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
+                bounds = merge(bounds, AABB(aabbs[i].getPosition(), 0u));
+            return bounds;
+        },
+        [](const AABB& a, const AABB& b) { return merge(a, b); });
+    const vec3<float> lower = bounds.getLower();
+    const vec3<float> extent = bounds.getUpper() - lower;
+    const vec3<float> scale(extent.x > 0 ? 1023.0f / extent.x : 0, extent.y > 0 ? 1023.0f / extent.y : 0,
+                            extent.z > 0 ? 1023.0f / extent.z : 0);
+
+    // compute the Morton code of each AABB center
+    std::vector<unsigned int> codes(N);
+    std::vector<unsigned int> idx(N);
+    util::forLoopWrapper(0, N, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const vec3<float> q = aabbs[i].getPosition() - lower;
+            codes[i] = (expandMortonBits(static_cast<unsigned int>(q.x * scale.x)) << 2)
+                | (expandMortonBits(static_cast<unsigned int>(q.y * scale.y)) << 1)
+                | expandMortonBits(static_cast<unsigned int>(q.z * scale.z));
+            idx[i] = i;
+        }
+    });
+
+    // sort the particles along the curve, breaking ties by index to make the tree deterministic
+    tbb::parallel_sort(idx.begin(), idx.end(), [&codes](unsigned int a, unsigned int b) {
+        return codes[a] < codes[b] || (codes[a] == codes[b] && a < b);
+    });
+    std::vector<unsigned int> sorted_codes(N);
+    util::forLoopWrapper(0, N, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            sorted_codes[i] = codes[idx[i]];
+    });
+
+    const unsigned int num_leaves = (N + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    reserveNodes(2 * num_leaves - 1);
+    m_num_nodes = 2 * num_leaves - 1;
+    m_root = 0;
+    buildNode(aabbs, idx, sorted_codes, m_root, 0, N, INVALID_NODE);
+}
 
-    std::vector<unsigned int> idx;
-    for (unsigned int i = 0; i < N; i++)
-        idx.push_back(i);
-
-    m_root = buildNode(aabbs, idx, 0, N, INVALID_NODE);
-    updateSkip(m_root);
+/*! \param codes Sorted Morton codes
+    \param start Start point in codes to examine
+    \param len Number of codes to examine (must be larger than NODE_CAPACITY)
+    \returns The number of particles in the left child, a positive multiple of NODE_CAPACITY smaller than len
+*/
+inline unsigned int AABBTree::findSplit(const std::vector<unsigned int>& codes, unsigned int start,
+                                        unsigned int len) const
+{
+    const unsigned int num_leaves = (len + NODE_CAPACITY - 1) / NODE_CAPACITY;
+    const unsigned int first_code = codes[start];
+    const unsigned int last_code = codes[start + len - 1];
+
+    // identical codes carry no spatial information, so split the range in half
+    if (first_code == last_code)
+        return (num_leaves / 2) * NODE_CAPACITY;
+
+    // all codes in the range share the bits above the highest differing bit, so they are partitioned by it
+    const unsigned int diff = first_code ^ last_code;
+    unsigned int bit = 1u << 31;
+    while (!(diff & bit))
+        bit >>= 1;
+    const unsigned int split
+        = std::partition_point(codes.begin() + start, codes.begin() + start + len,
+                               [bit](unsigned int code) { return !(code & bit); })
+        - (codes.begin() + start);
+
+    // round to the nearest leaf boundary, keeping at least one leaf on each side
+    const unsigned int split_leaves = (split + NODE_CAPACITY / 2) / NODE_CAPACITY;
+    return std::min(std::max(split_leaves, 1u), num_leaves - 1) * NODE_CAPACITY;
 }
 
 /*! \param aabbs List of AABBs
-    \param idx List of indices
-    \param start Start point in aabbs and idx to examine
-    \param len Number of aabbs to examine
+    \param idx List of particle indices in Morton order
+    \param codes Morton codes corresponding to idx
+    \param node Index of the node to build
+    \param start Start point in idx to examine
+    \param len Number of particles to examine
     \param parent Index of the parent node
 
-    buildNode is the main driver of the smart AABB tree build algorithm. Each call produces a node, given a
-   set of AABBs. If there are fewer AABBs than fit in a leaf, a leaf is generated. If there are too many, the
-   total AABB is computed and split on the largest length axis. The total tree is built by recursive
-   splitting.
-
-    The aabbs and idx lists are passed in by reference. Each node is given a subrange of the list to own
-   (start to start + len). When building the node, it partitions its subrange into two sides (like quick
-   sort).
+    buildNode writes the subtree of particles start to start + len in idx rooted at index node. The left child
+   directly follows its parent, and the right child follows the 2*leaves-1 nodes of the left subtree. Large
+   subtrees build their two children in parallel.
 */
-inline unsigned int AABBTree::buildNode(AABB* aabbs, std::vector<unsigned int>& idx, unsigned int start,
-                                        unsigned int len, unsigned int parent)
+inline void AABBTree::buildNode(const AABB* aabbs, const std::vector<unsigned int>& idx,
+                                const std::vector<unsigned int>& codes, unsigned int node, unsigned int start,
+                                unsigned int len, unsigned int parent)
 {
-    // merge all the AABBs into one
-    AABB my_aabb = aabbs[start];
-    for (unsigned int i = 1; i < len; i++)
-    {
-        my_aabb = merge(my_aabb, aabbs[start + i]);
-    }
-    vec3<float> my_radius = my_aabb.getUpper() - my_aabb.getLower();
+    AABBNode& my_node = m_nodes[node];
+    my_node = AABBNode();
+    my_node.parent = parent;
 
     // handle the case of a leaf node creation
     if (len <= NODE_CAPACITY)
     {
-        unsigned int new_node = allocateNode();
-        m_nodes[new_node].aabb = my_aabb;
-        m_nodes[new_node].parent = parent;
-        m_nodes[new_node].num_particles = len;
-
+        my_node.aabb = aabbs[idx[start]];
+        my_node.num_particles = len;
         for (unsigned int i = 0; i < len; i++)
         {
-            // assign the particle indices into the leaf node
-            m_nodes[new_node].particles[i] = idx[start + i];
-            m_nodes[new_node].particle_tags[i] = aabbs[start + i].tag;
+            const unsigned int particle = idx[start + i];
+            if (i > 0)
+                my_node.aabb = merge(my_node.aabb, aabbs[particle]);
+
+            // assign the particle indices and positions into the leaf node
+            my_node.particles[i] = particle;
+            my_node.particle_tags[i] = aabbs[particle].tag;
+            my_node.setParticlePosition(i, aabbs[particle]);
 
             // assign the reverse mapping from particle indices to leaf node indices
-            m_mapping[idx[start + i]] = new_node;
+            m_mapping[particle] = node;
         }
-
-        return new_node;
+        return;
     }
 
-    // otherwise, we are creating an internal node - allocate an index
-    unsigned int my_idx = allocateNode();
-
-    // need to split the list of aabbs into two sets for left and right
-    unsigned int start_left = 0;
-    unsigned int start_right = len;
+    const unsigned int split = findSplit(codes, start, len);
+    const unsigned int left = node + 1;
+    const unsigned int right = node + 2 * (split / NODE_CAPACITY);
 
-    // if there are only 2 aabbs, put one on each side
-    if (len == 2)
+    if (len > BUILD_SERIAL_CUTOFF)
     {
-        // nothing to do, already partitioned
+        tbb::parallel_invoke([&] { buildNode(aabbs, idx, codes, left, start, split, node); },
+                             [&] { buildNode(aabbs, idx, codes, right, start + split, len - split, node); });
     }
     else
     {
-        // otherwise, we need to split them based on a heuristic. split the longest dimension in half
-        if (my_radius.x > my_radius.y && my_radius.x > my_radius.z)
-        {
-            // split on x direction
-            for (unsigned int i = 0; i < start_right; i++)
-            {
-                if (aabbs[start + i].getPosition().x < my_aabb.getPosition().x)
-                {
-                    // if on the left side, everything is happy, just continue on
-                }
-                else
-                {
-                    // if on the right side, need to swap the current aabb with the one at
-                    // start_right-1, subtract one off of start_right to indicate the addition
-                    // of one to the right side and subtract 1 from i to look at the current
-                    // index (new aabb). This is quick and easy to write, but will randomize
-                    // indices - might need to look into a stable partitioning algorithm!
-                    std::swap(aabbs[start + i], aabbs[start + start_right - 1]);
-                    std::swap(idx[start + i], idx[start + start_right - 1]);
-                    start_right--;
-                    i--;
-                }
-            }
-        }
-        else if (my_radius.y > my_radius.z)
-        {
-            // split on y direction
-            for (unsigned int i = 0; i < start_right; i++)
-            {
-                if (aabbs[start + i].getPosition().y < my_aabb.getPosition().y)
-                {
-                    // if on the left side, everything is happy, just continue on
-                }
-                else
-                {
-                    // if on the right side, need to swap the current aabb with the one at
-                    // start_right-1, subtract one off of start_right to indicate the addition
-                    // of one to the right side and subtract 1 from i to look at the current
-                    // index (new aabb). This is quick and easy to write, but will randomize
-                    // indices - might need to look into a stable partitioning algorithm!
-                    std::swap(aabbs[start + i], aabbs[start + start_right - 1]);
-                    std::swap(idx[start + i], idx[start + start_right - 1]);
-                    start_right--;
-                    i--;
-                }
-            }
-        }
-        else
-        {
-            // split on z direction
-            for (unsigned int i = 0; i < start_right; i++)
-            {
-                if (aabbs[start + i].getPosition().z < my_aabb.getPosition().z)
-                {
-                    // if on the left side, everything is happy, just continue on
-                }
-                else
-                {
-                    // if on the right side, need to swap the current aabb with the one at
-                    // start_right-1, subtract one off of start_right to indicate the addition
-                    // of one to the right side and subtract 1 from i to look at the current
-                    // index (new aabb). This is quick and easy to write, but will randomize
-                    // indices - might need to look into a stable partitioning algorithm!
-                    std::swap(aabbs[start + i], aabbs[start + start_right - 1]);
-                    std::swap(idx[start + i], idx[start + start_right - 1]);
-                    start_right--;
-                    i--;
-                }
-            }
-        }
+        buildNode(aabbs, idx, codes, left, start, split, node);
+        buildNode(aabbs, idx, codes, right, start + split, len - split, node);
     }
 
-    // sanity check. The left or right tree may have ended up empty. If so, just borrow one particle from it
-    if (start_right == len)
-        start_right = len - 1;
-    if (start_right == 0)
-        start_right = 1;
-
-    // note: calling buildNode has side effects, the m_nodes array may be reallocated. So we need to determine
-    // the left and right children, then build our node (can't say m_nodes[my_idx].left = buildNode(...))
-    unsigned int new_left = buildNode(aabbs, idx, start + start_left, start_right - start_left, my_idx);
-    unsigned int new_right = buildNode(aabbs, idx, start + start_right, len - start_right, my_idx);
+    // the subtree holds 2*leaves-1 nodes, all of which are skipped along with this one
+    my_node.aabb = merge(m_nodes[left].aabb, m_nodes[right].aabb);
+    my_node.left = left;
+    my_node.right = right;
+    my_node.skip = 2 * ((len + NODE_CAPACITY - 1) / NODE_CAPACITY) - 2;
+}
 
-    // now, create the children and connect them up
-    m_nodes[my_idx].aabb = my_aabb;
-    m_nodes[my_idx].parent = parent;
-    m_nodes[my_idx].left = new_left;
-    m_nodes[my_idx].right = new_right;
+/*! \param aabbs List of AABBs for each particle, in the same order as the list the tree was built from
 
-    return my_idx;
+    Recomputes the AABB of every node bottom up so that it tightly encloses the new AABBs of its particles.
+   The tree topology is unchanged, so refit() is only efficient as long as the particles in each node stay
+   close to each other.
+*/
+inline void AABBTree::refit(const AABB* aabbs)
+{
+    if (m_num_nodes > 0)
+        refitNode(aabbs, m_root);
 }
 
-/*! \param idx Index of the node to update
+/*! \param aabbs List of AABBs for each particle
+    \param node Index of the node to refit
 
-    updateSkip() updates the skip field of every node in the tree. The skip field is used in the stackless
-    implementation of query. Each node's skip field lists the number of nodes that are children to this node.
-   Because of the order in which nodes are built in buildNode(), this number is the number of elements to skip
-   in a search if a box-box test does not overlap.
+    Large subtrees refit their two children in parallel.
 */
-inline unsigned int AABBTree::updateSkip(unsigned int idx)
+inline void AABBTree::refitNode(const AABB* aabbs, unsigned int node)
 {
-    // leaf nodes have no nodes under them
-    if (isNodeLeaf(idx))
+    AABBNode& my_node = m_nodes[node];
+    if (my_node.left == INVALID_NODE)
+    {
+        my_node.aabb = aabbs[my_node.particles[0]];
+        for (unsigned int i = 0; i < my_node.num_particles; i++)
+        {
+            if (i > 0)
+                my_node.aabb = merge(my_node.aabb, aabbs[my_node.particles[i]]);
+            my_node.setParticlePosition(i, aabbs[my_node.particles[i]]);
+        }
+        return;
+    }
+
+    if (my_node.skip > 2 * BUILD_SERIAL_CUTOFF / NODE_CAPACITY)
     {
-        return 1;
+        tbb::parallel_invoke([&] { refitNode(aabbs, my_node.left); },
+                             [&] { refitNode(aabbs, my_node.right); });
     }
     else
     {
-        // node idx needs to skip all the nodes underneath it (determined recursively)
-        unsigned int left_idx = m_nodes[idx].left;
-        unsigned int right_idx = m_nodes[idx].right;
-
-        unsigned int skip = updateSkip(left_idx) + updateSkip(right_idx);
-        m_nodes[idx].skip = skip;
-        return skip + 1;
+        refitNode(aabbs, my_node.left);
+        refitNode(aabbs, my_node.right);
     }
+    my_node.aabb = merge(m_nodes[my_node.left].aabb, m_nodes[my_node.right].aabb);
 }
 
-/*! Allocates a new node in the tree
- */
-inline unsigned int AABBTree::allocateNode()
+/*! \returns The sum of the surface areas of the AABBs of all nodes
+
+    The total surface area is proportional to the expected number of nodes a query visits, and unlike the
+   total volume it is meaningful for the flat nodes of 2D systems.
+*/
+inline float AABBTree::getTotalArea() const
 {
-    // grow the memory if needed
-    if (m_num_nodes >= m_node_capacity)
-    {
-        // determine new capacity
-        AABBNode* m_new_nodes = NULL;
-        unsigned int m_new_node_capacity = m_node_capacity * 2;
-        if (m_new_node_capacity == 0)
-            m_new_node_capacity = 16;
-
-        // allocate new memory
-        int retval = posix_memalign((void**) &m_new_nodes, 32, m_new_node_capacity * sizeof(AABBNode));
-        if (retval != 0)
-        {
-            throw std::runtime_error("Error allocating AABBTree memory");
-        }
+    const AABBNode* nodes = m_nodes;
+    return static_cast<float>(tbb::parallel_reduce(
+        tbb::blocked_range<unsigned int>(0, m_num_nodes), double(0),
+        [nodes](const tbb::blocked_range<unsigned int>& r, double area) {
+            for (unsigned int i = r.begin(); i != r.end(); ++i)
+            {
+                const vec3<float> extent = nodes[i].aabb.getUpper() - nodes[i].aabb.getLower();
+                area += 2 * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+            }
+            return area;
+        },
+        [](double a, double b) { return a + b; }));
+}
 
-        // if we have old memory, copy it over
-        if (m_nodes != NULL)
-        {
-            std::memcpy((void*) m_new_nodes, (void*) m_nodes, sizeof(AABBNode) * m_num_nodes);
-            posix_memalign_free(m_nodes);
-        }
-        m_nodes = m_new_nodes;
-        m_node_capacity = m_new_node_capacity;
+/*! \param num_nodes Number of nodes the tree must be able to hold
+
+    Grows the node array without preserving its contents.
+*/
+inline void AABBTree::reserveNodes(unsigned int num_nodes)
+{
+    if (num_nodes <= m_node_capacity)
+        return;
+
+    if (m_nodes != NULL)
+    {
+        posix_memalign_free(m_nodes);
+        m_nodes = NULL;
+        m_node_capacity = 0;
     }
 
-    m_nodes[m_num_nodes] = AABBNode();
-    m_num_nodes++;
-    return m_num_nodes - 1;
+    int retval = posix_memalign((void**) &m_nodes, 32, num_nodes * sizeof(AABBNode));
+    if (retval != 0)
+    {
+        m_nodes = NULL;
+        throw std::runtime_error("Error allocating AABBTree memory");
+    }
+    m_node_capacity = num_nodes;
 }
 
 }; }; // end namespace freud::locality
@@ -90,6 +90,24 @@ public:
         return m_histogram.getAxisSizes();
     }
 
+    //! Set whether all threads count bonds in a single shared histogram.
+    /*! By default, each thread counts bonds in its own copy of the histogram.
+     *  Sharing one histogram with atomic increments keeps the memory constant
+     *  with the number of threads, which pays off for histograms with many
+     *  bins. The bin counts are the same either way. Only m_local_histograms
+     *  is shared; other thread local storage of subclasses is not.
+     */
+    void setSharedHistogram(bool shared)
+    {
+        m_local_histograms.setShared(shared);
+    }
+
+    //! Return whether all threads bin bonds into a single shared histogram.
+    bool isSharedHistogram() const
+    {
+        return m_local_histograms.isShared();
+    }
+
     //! \internal
     // Wrapper to do accumulation.
     /*! \param neighbor_query NeighborQuery object to iterate over
@@ -2,10 +2,13 @@
 // This file is from the freud project, released under the BSD 3-Clause License.
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <stdexcept>
+#include <tuple>
 
 #include "LinkCell.h"
+#include "NeighborHeap.h"
 
 #if defined _WIN32
 #undef min // std::min clashes with a Windows header
@@ -18,16 +21,140 @@
 
 namespace freud { namespace locality {
 
+/***************
+ * CellStencil *
+ ***************/
+const float CellStencil::CELL_FRACTION_SLACK = 1e-3;
+
+namespace {
+//! Compute the minimum separation along one dimension between a point and any image of an offset cell.
+/*! The cell at a given offset is also reached by the offsets shifted by
+ *  the number of cells along the dimension, so the smallest separation of
+ *  these images is a lower bound for all of them.
+ */
+float periodicAxisGap(int offset, float cell_fraction, float cell_width, unsigned int num_cells)
+{
+    const int n = static_cast<int>(num_cells);
+    return std::min(CellStencil::axisGap(offset, cell_fraction, cell_width, false),
+                    std::min(CellStencil::axisGap(offset - n, cell_fraction, cell_width, false),
+                             CellStencil::axisGap(offset + n, cell_fraction, cell_width, false)));
+}
+
+//! Compute the cell offsets to search along one dimension.
+/*! If the offsets would wrap around the periodic box, every cell is listed
+ *  exactly once instead.
+ */
+std::vector<int> stencilAxisOffsets(unsigned int num_cells, float cell_width, float r_max, bool& wrapped)
+{
+    std::vector<int> axis_offsets;
+    const float max_range = r_max / cell_width + 1;
+    wrapped = (2 * max_range + 1 > float(num_cells));
+    if (wrapped)
+    {
+        for (unsigned int i = 0; i < num_cells; ++i)
+        {
+            axis_offsets.push_back(i);
+        }
+    }
+    else
+    {
+        const int range = static_cast<int>(max_range);
+        axis_offsets.push_back(0);
+        for (int i = 1; i <= range; ++i)
+        {
+            axis_offsets.push_back(-i);
+            axis_offsets.push_back(i);
+        }
+    }
+    return axis_offsets;
+}
+}; // namespace
+
+CellStencil::CellStencil(const box::Box& box, const vec3<unsigned int>& celldim, float r_max)
+    : m_wrapped(false, false, true)
+{
+    const vec3<float> L = box.getNearestPlaneDistance();
+    const bool is2D = box.is2D();
+    m_cell_widths = vec3<float>(L.x / float(celldim.x), L.y / float(celldim.y),
+                                is2D ? 0 : L.z / float(celldim.z));
+    m_orthogonal = (box.getTiltFactorXY() == 0 && box.getTiltFactorXZ() == 0 && box.getTiltFactorYZ() == 0);
+
+    const std::vector<int> offsets_x = stencilAxisOffsets(celldim.x, m_cell_widths.x, r_max, m_wrapped.x);
+    const std::vector<int> offsets_y = stencilAxisOffsets(celldim.y, m_cell_widths.y, r_max, m_wrapped.y);
+    const std::vector<int> offsets_z = is2D
+        ? std::vector<int>(1, 0)
+        : stencilAxisOffsets(celldim.z, m_cell_widths.z, r_max, m_wrapped.z);
+
+    // The minimum distance from any point in the central cell to an offset
+    // cell is obtained by placing the point on the nearest face.
+    const float r_max_sq = r_max * r_max;
+    std::vector<std::pair<float, vec3<int>>> candidates;
+    for (int dz : offsets_z)
+    {
+        for (int dy : offsets_y)
+        {
+            for (int dx : offsets_x)
+            {
+                const vec3<int> offset(dx, dy, dz);
+                const vec3<float> nearest_face(dx > 0 ? 1 : 0, dy > 0 ? 1 : 0, dz > 0 ? 1 : 0);
+                const float min_distance_sq = minDistanceSq(offset, nearest_face);
+                if (min_distance_sq < r_max_sq)
+                {
+                    candidates.emplace_back(min_distance_sq, offset);
+                }
+            }
+        }
+    }
+
+    // Search the closest cells first. The stable sort keeps the central cell,
+    // which is generated first, at the front of the stencil.
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const std::pair<float, vec3<int>>& a, const std::pair<float, vec3<int>>& b) {
+                         return a.first < b.first;
+                     });
+    m_offsets.reserve(candidates.size());
+    for (const auto& candidate : candidates)
+    {
+        m_offsets.push_back(candidate.second);
+    }
+
+    // A pair of points in cells c and c + d is found from the other cell with
+    // the mirror offset, which is -d, or n - d along wrapped dimensions. Since
+    // the stencil maps distinct offsets to distinct cells, keeping one offset
+    // of each mirror pair finds each pair of points once.
+    const auto mirrorAxis = [](int offset, unsigned int num_cells, bool wrapped) {
+        return wrapped ? static_cast<int>((num_cells - offset) % num_cells) : -offset;
+    };
+    std::vector<vec3<int>> mirrored_half_offsets;
+    for (const vec3<int>& offset : m_offsets)
+    {
+        const vec3<int> mirror(mirrorAxis(offset.x, celldim.x, m_wrapped.x),
+                               mirrorAxis(offset.y, celldim.y, m_wrapped.y),
+                               is2D ? 0 : mirrorAxis(offset.z, celldim.z, m_wrapped.z));
+        if (mirror == offset)
+        {
+            m_half_offsets.push_back(offset);
+        }
+        else if (std::make_tuple(offset.z, offset.y, offset.x)
+                 > std::make_tuple(mirror.z, mirror.y, mirror.x))
+        {
+            mirrored_half_offsets.push_back(offset);
+        }
+    }
+    m_num_ordered_half_offsets = m_half_offsets.size();
+    m_half_offsets.insert(m_half_offsets.end(), mirrored_half_offsets.begin(), mirrored_half_offsets.end());
+}
+
 /********************
  * IteratorLinkCell *
  ********************/
 void IteratorLinkCell::copy(const IteratorLinkCell& rhs)
 {
-    m_cell_list = rhs.m_cell_list;
-    m_Np = rhs.m_Np;
-    m_Nc = rhs.m_Nc;
+    m_sorted_indices = rhs.m_sorted_indices;
+    m_cell_begin = rhs.m_cell_begin;
+    m_cell_end = rhs.m_cell_end;
+    m_cur_pos = rhs.m_cur_pos;
     m_cur_idx = rhs.m_cur_idx;
-    m_cell = rhs.m_cell;
 }
 
 bool IteratorLinkCell::atEnd()
@@ -37,15 +164,22 @@ bool IteratorLinkCell::atEnd()
 
 unsigned int IteratorLinkCell::next()
 {
-    m_cur_idx = m_cell_list[m_cur_idx];
+    if (m_cur_pos < m_cell_end)
+    {
+        m_cur_idx = m_sorted_indices.get()[m_cur_pos];
+        ++m_cur_pos;
+    }
+    else
+    {
+        m_cur_idx = LINK_CELL_TERMINATOR;
+    }
     return m_cur_idx;
 }
 
 unsigned int IteratorLinkCell::begin()
 {
-    m_cur_idx = m_Np + m_cell;
-    m_cur_idx = m_cell_list[m_cur_idx];
-    return m_cur_idx;
+    m_cur_pos = m_cell_begin;
+    return next();
 }
 
 /*********************
@@ -301,23 +435,163 @@ void LinkCell::computeCellList(const vec3<float>* points, unsigned int n_points)
 {
     // determine the number of cells and allocate memory
     unsigned int Nc = getNumCells();
-    m_cell_list.prepare(n_points + Nc);
+    m_point_cells.prepare(n_points);
+    m_cell_offsets.prepare(Nc + 1);
+    m_sorted_indices.prepare(n_points);
+    m_sorted_points.prepare(n_points);
     m_n_points = n_points;
     m_Nc = Nc;
 
-    // initialize memory
-    for (unsigned int cell = 0; cell < Nc; cell++)
+    unsigned int* point_cells = m_point_cells.get();
+    unsigned int* cell_offsets = m_cell_offsets.get();
+    unsigned int* sorted_indices = m_sorted_indices.get();
+    vec3<float>* sorted_points = m_sorted_points.get();
+
+    // compute the cell of each point and count the points in each cell
+    std::vector<std::atomic<unsigned int>> cell_counts(Nc);
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const unsigned int cell = getCell(points[i]);
+            point_cells[i] = cell;
+            cell_counts[cell].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // The exclusive prefix sum of the counts gives the offset of each cell.
+    // There are typically an order of magnitude fewer cells than points, so
+    // the scan is done serially. The counts are reused as insertion cursors.
+    cell_offsets[0] = 0;
+    for (unsigned int cell = 0; cell < Nc; ++cell)
     {
-        m_cell_list[n_points + cell] = LINK_CELL_TERMINATOR;
+        cell_offsets[cell + 1] = cell_offsets[cell] + cell_counts[cell].load(std::memory_order_relaxed);
+        cell_counts[cell].store(cell_offsets[cell], std::memory_order_relaxed);
     }
 
-    // generate the cell list
-    for (int i = n_points - 1; i >= 0; i--)
+    // scatter the point indices into their cells
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            sorted_indices[cell_counts[point_cells[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+        }
+    });
+
+    // The parallel scatter leaves the points of each cell in arbitrary order,
+    // so sort each cell by index to make neighbor iteration deterministic and
+    // then gather the positions in cell order.
+    util::forLoopWrapper(0, Nc, [&](size_t begin, size_t end) {
+        for (size_t cell = begin; cell < end; ++cell)
+        {
+            std::sort(sorted_indices + cell_offsets[cell], sorted_indices + cell_offsets[cell + 1]);
+            for (unsigned int k = cell_offsets[cell]; k < cell_offsets[cell + 1]; ++k)
+            {
+                sorted_points[k] = points[sorted_indices[k]];
+            }
+        }
+    });
+}
+
+void LinkCell::update(const vec3<float>* points, unsigned int n_points)
+{
+    setPoints(points, n_points);
+
+    if (n_points != m_n_points)
     {
-        unsigned int cell = getCell(points[i]);
-        m_cell_list[i] = m_cell_list[n_points + cell];
-        m_cell_list[n_points + cell] = i;
+        computeCellList(points, n_points);
+        return;
     }
+
+    // find the points that changed cells
+    typedef std::vector<std::pair<unsigned int, unsigned int>> CellMoves;
+    tbb::enumerable_thread_specific<CellMoves> local_moves;
+    const unsigned int* point_cells = m_point_cells.get();
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        CellMoves& moves = local_moves.local();
+        for (size_t i = begin; i < end; ++i)
+        {
+            const unsigned int cell = getCell(points[i]);
+            if (cell != point_cells[i])
+            {
+                moves.emplace_back(cell, i);
+            }
+        }
+    });
+    CellMoves moves;
+    for (const CellMoves& thread_moves : local_moves)
+    {
+        moves.insert(moves.end(), thread_moves.begin(), thread_moves.end());
+    }
+
+    if (!moves.empty())
+    {
+        // Sort the moved points by destination cell and index so that the
+        // arrivals of each cell can be merged with the points that stayed.
+        std::sort(moves.begin(), moves.end());
+
+        // Compute the new cell offsets from the net change of each cell.
+        const unsigned int Nc = m_Nc;
+        m_update_offsets.prepare(Nc + 1);
+        unsigned int* old_offsets = m_cell_offsets.get();
+        unsigned int* new_offsets = m_update_offsets.get();
+        for (const std::pair<unsigned int, unsigned int>& move : moves)
+        {
+            ++new_offsets[move.first + 1];
+            --new_offsets[point_cells[move.second] + 1];
+        }
+        for (unsigned int cell = 0; cell < Nc; ++cell)
+        {
+            new_offsets[cell + 1] += new_offsets[cell] + (old_offsets[cell + 1] - old_offsets[cell]);
+        }
+        for (const std::pair<unsigned int, unsigned int>& move : moves)
+        {
+            m_point_cells[move.second] = move.first;
+        }
+
+        // Merge the points that stayed in each cell with the arrivals, both
+        // of which are sorted by index.
+        m_update_indices.prepare(n_points);
+        const unsigned int* old_indices = m_sorted_indices.get();
+        unsigned int* new_indices = m_update_indices.get();
+        util::forLoopWrapper(0, Nc, [&](size_t begin, size_t end) {
+            for (size_t cell = begin; cell < end; ++cell)
+            {
+                std::vector<std::pair<unsigned int, unsigned int>>::const_iterator arrival = std::lower_bound(
+                    moves.begin(), moves.end(), std::make_pair(static_cast<unsigned int>(cell), 0u));
+                unsigned int k = old_offsets[cell];
+                unsigned int out = new_offsets[cell];
+                while (out < new_offsets[cell + 1])
+                {
+                    // Skip the points that left this cell.
+                    while (k < old_offsets[cell + 1] && point_cells[old_indices[k]] != cell)
+                    {
+                        ++k;
+                    }
+                    if (k < old_offsets[cell + 1]
+                        && (arrival == moves.end() || arrival->first != cell
+                            || old_indices[k] < arrival->second))
+                    {
+                        new_indices[out++] = old_indices[k++];
+                    }
+                    else
+                    {
+                        new_indices[out++] = (arrival++)->second;
+                    }
+                }
+            }
+        });
+        std::swap(m_cell_offsets, m_update_offsets);
+        std::swap(m_sorted_indices, m_update_indices);
+    }
+
+    // gather the positions in cell order
+    const unsigned int* sorted_indices = m_sorted_indices.get();
+    vec3<float>* sorted_points = m_sorted_points.get();
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k)
+        {
+            sorted_points[k] = points[sorted_indices[k]];
+        }
+    });
 }
 
 vec3<unsigned int> LinkCell::indexToCoord(unsigned int x) const
@@ -353,6 +627,44 @@ vec3<unsigned int> LinkCell::getCellCoord(const vec3<float> p) const
     return c;
 }
 
+vec3<unsigned int> LinkCell::getCellCoord(const vec3<float> p, vec3<float>& cell_fraction) const
+{
+    vec3<float> alpha = m_box.makeFractional(p);
+    vec3<float> scaled(alpha.x * float(m_celldim.x), alpha.y * float(m_celldim.y),
+                       alpha.z * float(m_celldim.z));
+    vec3<float> floored(std::floor(scaled.x), std::floor(scaled.y), std::floor(scaled.z));
+    cell_fraction = scaled - floored;
+    vec3<unsigned int> c;
+    c.x = (unsigned int) floored.x;
+    c.x %= m_celldim.x;
+    c.y = (unsigned int) floored.y;
+    c.y %= m_celldim.y;
+    c.z = (unsigned int) floored.z;
+    c.z %= m_celldim.z;
+    return c;
+}
+
+const CellStencil& LinkCell::getStencil(float r_max) const
+{
+    // check if the stencil has been already computed
+    // return the stencil if it has
+    // otherwise, compute it and return
+    CellStencils::const_accessor a;
+    if (m_cell_stencils.find(a, r_max))
+    {
+        return a->second;
+    }
+    else
+    {
+        CellStencils::accessor b;
+        if (m_cell_stencils.insert(b, r_max))
+        {
+            b->second = CellStencil(m_box, m_celldim, r_max);
+        }
+        return b->second;
+    }
+}
+
 const std::vector<unsigned int>& LinkCell::getCellNeighbors(unsigned int cell) const
 {
     // check if the list of neighbors has been already computed
@@ -476,31 +788,109 @@ LinkCell::querySingle(const vec3<float> query_point, unsigned int query_point_id
     }
 }
 
+void LinkCell::queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                          QueryArgs args, std::vector<NeighborBond>& bonds) const
+{
+    this->validateQueryArgs(args);
+    if (args.mode == QueryArgs::ball)
+    {
+        queryBallBatch(query_points, begin, end, args, bonds);
+    }
+    else
+    {
+        NeighborQuery::queryBatch(query_points, begin, end, args, bonds);
+    }
+}
+
+void LinkCell::queryBallBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                              const QueryArgs& args, std::vector<NeighborBond>& bonds) const
+{
+    const float r_max_sq = args.r_max * args.r_max;
+    const float r_min_sq = args.r_min * args.r_min;
+
+    // To find each pair only once, only half of the stencil is searched and
+    // pairs within cells that are their own mirror image are ordered by index.
+    const CellStencil& stencil = getStencil(args.r_max);
+    const std::vector<vec3<int>>& offsets
+        = args.unique_pairs ? stencil.getHalfOffsets() : stencil.getOffsets();
+    const unsigned int num_ordered_offsets = args.unique_pairs ? stencil.getNumOrderedHalfOffsets() : 0;
+
+    const unsigned int* cell_offsets = m_cell_offsets.get();
+    const unsigned int* sorted_indices = m_sorted_indices.get();
+    const vec3<float>* sorted_points = m_sorted_points.get();
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        const vec3<float> query_point = query_points[i];
+        vec3<float> cell_fraction;
+        const vec3<unsigned int> point_cell(getCellCoord(query_point, cell_fraction));
+        const vec3<int> point_cell_coord(point_cell.x, point_cell.y, point_cell.z);
+
+        for (unsigned int s = 0; s < offsets.size(); ++s)
+        {
+            // Skip cells that are entirely out of range of this point.
+            if (stencil.minDistanceSq(offsets[s], cell_fraction) >= r_max_sq)
+            {
+                continue;
+            }
+
+            const bool ordered = (s < num_ordered_offsets);
+            const unsigned int cell = getCellIndex(point_cell_coord + offsets[s]);
+            for (unsigned int k = cell_offsets[cell]; k < cell_offsets[cell + 1]; ++k)
+            {
+                const unsigned int j = sorted_indices[k];
+
+                // Skip ii matches immediately if requested.
+                if (args.exclude_ii && i == j)
+                {
+                    continue;
+                }
+
+                // Pairs within self-mirrored cells are found by their lower index.
+                if (ordered && j < i)
+                {
+                    continue;
+                }
+
+                const vec3<float> r_ij(m_box.wrap(sorted_points[k] - query_point));
+                const float r_sq(dot(r_ij, r_ij));
+
+                if (r_sq < r_max_sq && r_sq >= r_min_sq)
+                {
+                    bonds.emplace_back(i, j, std::sqrt(r_sq));
+                }
+            }
+        }
+    }
+}
+
 NeighborBond LinkCellQueryBallIterator::next()
 {
     float r_max_sq = m_r_max * m_r_max;
     float r_min_sq = m_r_min * m_r_min;
 
-    vec3<unsigned int> point_cell(m_linkcell->getCellCoord(m_query_point));
-    const unsigned int point_cell_index = m_linkcell->getCellIndex(
-        vec3<int>(point_cell.x, point_cell.y, point_cell.z) + (*m_neigh_cell_iter));
-    m_searched_cells.insert(point_cell_index);
+    const unsigned int* sorted_indices = m_linkcell->getSortedIndices().get();
+    const vec3<float>* sorted_points = m_linkcell->getSortedPoints().get();
+    const std::vector<vec3<int>>& offsets = m_stencil.getOffsets();
 
-    // Loop over cell list neighbor shells relative to this point's cell.
+    // Loop over the cells of the stencil relative to this point's cell.
     while (true)
     {
-        // Iterate over the particles in that cell. Using a local counter
-        // variable is safe, because the IteratorLinkCell object is keeping
-        // track between calls to next.
-        for (unsigned int j = m_cell_iter.next(); !m_cell_iter.atEnd(); j = m_cell_iter.next())
+        // Iterate over the particles in that cell. The cell position is a
+        // member, so it keeps track of our progress between calls to next.
+        while (m_cell_pos < m_cell_end)
         {
+            const unsigned int j = sorted_indices[m_cell_pos];
+            const vec3<float> point = sorted_points[m_cell_pos];
+            // Increment before possible return.
+            ++m_cell_pos;
+
             // Skip ii matches immediately if requested.
             if (m_exclude_ii && m_query_point_idx == j)
             {
                 continue;
             }
 
-            const vec3<float> r_ij(m_neighbor_query->getBox().wrap((*m_linkcell)[j] - m_query_point));
+            const vec3<float> r_ij(m_neighbor_query->getBox().wrap(point - m_query_point));
             const float r_sq(dot(r_ij, r_ij));
 
             if (r_sq < r_max_sq && r_sq >= r_min_sq)
@@ -509,39 +899,19 @@ NeighborBond LinkCellQueryBallIterator::next()
             }
         }
 
-        bool out_of_range = false;
-
-        while (true)
+        // Advance to the next cell of the stencil that may contain points
+        // within r_max of the query point.
+        while (m_stencil_idx < offsets.size()
+               && m_stencil.minDistanceSq(offsets[m_stencil_idx], m_cell_fraction) >= r_max_sq)
         {
-            // Determine the next neighbor cell to consider. We're done if we
-            // reach a new shell and the closest point of approach to the new
-            // shell is greater than our r_max.
-            ++m_neigh_cell_iter;
-
-            if ((m_neigh_cell_iter.getRange() - m_extra_search_width) * m_linkcell->getCellWidth() > m_r_max)
-            {
-                out_of_range = true;
-                break;
-            }
-
-            const unsigned int neighbor_cell_index = m_linkcell->getCellIndex(
-                vec3<int>(point_cell.x, point_cell.y, point_cell.z) + (*m_neigh_cell_iter));
-            // Insertion to an unordered set returns a pair, the second
-            // element indicates insertion success or failure (if it
-            // already exists)
-            if (m_searched_cells.insert(neighbor_cell_index).second)
-            {
-                // This cell has not been searched yet, so we will iterate
-                // over its contents. Otherwise, we loop back, increment
-                // the cell shell iterator, and try the next one.
-                m_cell_iter = m_linkcell->itercell(neighbor_cell_index);
-                break;
-            }
+            ++m_stencil_idx;
         }
-        if (out_of_range)
+        if (m_stencil_idx == offsets.size())
         {
             break;
         }
+        setCell(m_linkcell->getCellIndex(m_point_cell + offsets[m_stencil_idx]));
+        ++m_stencil_idx;
     }
 
     m_finished = true;
@@ -550,100 +920,106 @@ NeighborBond LinkCellQueryBallIterator::next()
 
 NeighborBond LinkCellQueryIterator::next()
 {
-    float r_max_sq = m_r_max * m_r_max;
-    float r_min_sq = m_r_min * m_r_min;
+    // This iterator is not truly lazy; it finds all neighbors the first time
+    // next is called and then returns them one by one.
+    if (!m_searched)
+    {
+        findNeighbors();
+        m_searched = true;
+    }
 
-    vec3<float> plane_distance = m_neighbor_query->getBox().getNearestPlaneDistance();
-    float min_plane_distance = std::min(plane_distance.x, plane_distance.y);
-    if (!m_neighbor_query->getBox().is2D())
+    if (m_count < m_current_neighbors.size())
     {
-        min_plane_distance = std::min(min_plane_distance, plane_distance.z);
+        return m_current_neighbors[m_count++];
     }
-    unsigned int max_range = std::ceil(min_plane_distance / (2 * m_linkcell->getCellWidth())) + 1;
 
-    vec3<unsigned int> point_cell(m_linkcell->getCellCoord(m_query_point));
-    const unsigned int point_cell_index = m_linkcell->getCellIndex(
-        vec3<int>(point_cell.x, point_cell.y, point_cell.z) + (*m_neigh_cell_iter));
-    m_searched_cells.insert(point_cell_index);
+    m_finished = true;
+    return NeighborQueryIterator::ITERATOR_TERMINATOR;
+}
 
-    // Loop over cell list neighbor shells relative to this point's cell.
-    if (!m_current_neighbors.size())
+void LinkCellQueryIterator::findNeighbors()
+{
+    const float r_max_sq = m_r_max * m_r_max;
+    const float r_min_sq = m_r_min * m_r_min;
+    const box::Box& box = m_neighbor_query->getBox();
+    const bool is2D = box.is2D();
+
+    const vec3<float> plane_distance = box.getNearestPlaneDistance();
+    float min_plane_distance = std::min(plane_distance.x, plane_distance.y);
+    if (!is2D)
     {
-        // Expand search cell radius until termination conditions are met.
-        while (m_neigh_cell_iter != IteratorCellShell(max_range, m_neighbor_query->getBox().is2D()))
+        min_plane_distance = std::min(min_plane_distance, plane_distance.z);
+    }
+    const unsigned int max_range = std::ceil(min_plane_distance / (2 * m_linkcell->getCellWidth())) + 1;
+
+    // The cell geometry used to bound the distance to the points of a cell.
+    const vec3<unsigned int> celldim = m_linkcell->getCellDims();
+    const vec3<float> cell_widths(plane_distance.x / float(celldim.x), plane_distance.y / float(celldim.y),
+                                  is2D ? 0 : plane_distance.z / float(celldim.z));
+    const bool orthogonal
+        = (box.getTiltFactorXY() == 0 && box.getTiltFactorXZ() == 0 && box.getTiltFactorYZ() == 0);
+
+    vec3<float> cell_fraction;
+    const vec3<unsigned int> point_cell(m_linkcell->getCellCoord(m_query_point, cell_fraction));
+    const vec3<int> point_cell_coord(point_cell.x, point_cell.y, point_cell.z);
+
+    const unsigned int* cell_offsets = m_linkcell->getCellOffsets().get();
+    const unsigned int* sorted_indices = m_linkcell->getSortedIndices().get();
+    const vec3<float>* sorted_points = m_linkcell->getSortedPoints().get();
+
+    NeighborHeap heap(m_num_neighbors);
+    const IteratorCellShell shell_end(max_range, is2D);
+    for (; m_neigh_cell_iter != shell_end; ++m_neigh_cell_iter)
+    {
+        // Until k neighbors are found, only bonds within r_max are kept.
+        // Afterwards, only bonds closer than the k-th nearest one can be.
+        const float cutoff = heap.full() ? std::min(heap.maxDistance(), m_r_max) : m_r_max;
+
+        // Every cell of the current shell is at least (range - 1) cell
+        // widths away, and cells in later shells are farther.
+        if ((m_neigh_cell_iter.getRange() - 1) * m_linkcell->getCellWidth() >= cutoff)
         {
-            // Iterate over the particles in that cell. Using a local counter
-            // variable is safe, because the IteratorLinkCell object is keeping
-            // track between calls to next. However, we have to add an extra
-            // check outside to proof ourselves against returning after
-            // previous calls to next that have not yet reset the iterator.
-            if (!m_cell_iter.atEnd())
-            {
-                for (unsigned int j = m_cell_iter.next(); !m_cell_iter.atEnd(); j = m_cell_iter.next())
-                {
-                    // Skip ii matches immediately if requested.
-                    if (m_exclude_ii && m_query_point_idx == j)
-                    {
-                        continue;
-                    }
-                    const vec3<float> r_ij(m_neighbor_query->getBox().wrap((*m_linkcell)[j] - m_query_point));
-                    const float r_sq(dot(r_ij, r_ij));
-                    if (r_sq < r_max_sq && r_sq >= r_min_sq)
-                        m_current_neighbors.emplace_back(m_query_point_idx, j, std::sqrt(r_sq));
-                }
-            }
+            break;
+        }
 
-            while (true)
-            {
-                ++m_neigh_cell_iter;
+        // Skip cells that are too far from the query point. The bound
+        // accounts for all periodic images of the cell, so it is the same
+        // for every offset that wraps onto the same cell.
+        const vec3<int> offset(*m_neigh_cell_iter);
+        const float gap_x = periodicAxisGap(offset.x, cell_fraction.x, cell_widths.x, celldim.x);
+        const float gap_y = periodicAxisGap(offset.y, cell_fraction.y, cell_widths.y, celldim.y);
+        const float gap_z = periodicAxisGap(offset.z, cell_fraction.z, cell_widths.z, celldim.z);
+        if (CellStencil::combineGaps(gap_x, gap_y, gap_z, orthogonal) >= cutoff * cutoff)
+        {
+            continue;
+        }
 
-                if (m_neigh_cell_iter == IteratorCellShell(max_range, m_neighbor_query->getBox().is2D()))
-                {
-                    break;
-                }
+        // Insertion to an unordered set returns a pair, the second element
+        // indicates insertion success or failure (if it already exists).
+        const unsigned int cell = m_linkcell->getCellIndex(point_cell_coord + offset);
+        if (!m_searched_cells.insert(cell).second)
+        {
+            continue;
+        }
 
-                const unsigned int neighbor_cell_index = m_linkcell->getCellIndex(
-                    vec3<int>(point_cell.x, point_cell.y, point_cell.z) + (*m_neigh_cell_iter));
-                // Insertion to an unordered set returns a pair, the second
-                // element indicates insertion success or failure (if it
-                // already exists)
-                if (m_searched_cells.insert(neighbor_cell_index).second)
-                {
-                    // This cell has not been searched yet, so we will
-                    // iterate over its contents. Otherwise, we loop back,
-                    // increment the cell shell iterator, and try the next
-                    // one.
-                    m_cell_iter = m_linkcell->itercell(neighbor_cell_index);
-                    break;
-                }
+        for (unsigned int cell_pos = cell_offsets[cell]; cell_pos < cell_offsets[cell + 1]; ++cell_pos)
+        {
+            const unsigned int j = sorted_indices[cell_pos];
+            // Skip ii matches immediately if requested.
+            if (m_exclude_ii && m_query_point_idx == j)
+            {
+                continue;
             }
-
-            // We can terminate early if we determine when we reach a shell
-            // such that we already have k neighbors closer than the
-            // closest possible neighbor in the new shell.
-            std::sort(m_current_neighbors.begin(), m_current_neighbors.end());
-            if ((m_current_neighbors.size() >= m_num_neighbors)
-                && (m_current_neighbors[m_num_neighbors - 1].distance
-                    < (m_neigh_cell_iter.getRange() - 1) * m_linkcell->getCellWidth()))
+            const vec3<float> r_ij(box.wrap(sorted_points[cell_pos] - m_query_point));
+            const float r_sq(dot(r_ij, r_ij));
+            if (r_sq < r_max_sq && r_sq >= r_min_sq)
             {
-                break;
+                heap.insert(NeighborBond(m_query_point_idx, j, std::sqrt(r_sq)));
             }
         }
     }
 
-    while ((m_count < m_num_neighbors) && (m_count < m_current_neighbors.size()))
-    {
-        m_count++;
-        if (m_current_neighbors[m_count - 1].distance > m_r_max)
-        {
-            m_finished = true;
-            return NeighborQueryIterator::ITERATOR_TERMINATOR;
-        }
-        return m_current_neighbors[m_count - 1];
-    }
-
-    m_finished = true;
-    return NeighborQueryIterator::ITERATOR_TERMINATOR;
+    heap.popSorted(m_current_neighbors);
 }
 
 }; }; // end namespace freud::locality
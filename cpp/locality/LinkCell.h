@@ -4,6 +4,7 @@
 #ifndef LINKCELL_H
 #define LINKCELL_H
 
+#include <algorithm>
 #include <memory>
 #include <tbb/concurrent_hash_map.h>
 #include <unordered_set>
@@ -20,16 +21,18 @@
 namespace freud { namespace locality {
 
 /*! \internal
-    \brief Signifies the end of the linked list
+    \brief Signifies the end of the particles in a cell
 */
 const unsigned int LINK_CELL_TERMINATOR = 0xffffffff;
 
 //! Iterates over particles in a link cell list generated by LinkCell
-/*! The link-cell structure is not trivial to iterate over. This helper class
- *  makes that easier both in C++ and provides a Python compatible interface
- *  for direct usage there. An IteratorLinkCell is given the bare essentials
- *  it needs to iterate over a given cell, the cell list, the number of
- *  particles, number of cells and the cell to iterate over. Call next() to
+/*! LinkCell stores the indices of its points sorted by cell, so the points of
+ *  a cell form a contiguous range of that array. This helper class provides a
+ *  compatibility view of such a range with the interface of the classic
+ *  linked-list cell iterator, both in C++ and through a Python compatible
+ *  interface for direct usage there. An IteratorLinkCell is given the bare
+ *  essentials it needs to iterate over a given cell, the cell-sorted point
+ *  indices and the range of that array belonging to the cell. Call next() to
  *  get the index of the next particle in the cell, atEnd() will return true
  *  if you are at the end. In C++, next() will crash the code if you attempt
  *  to iterate past the end (no bounds checking for performance). When called
@@ -52,15 +55,13 @@ const unsigned int LINK_CELL_TERMINATOR = 0xffffffff;
 class IteratorLinkCell
 {
 public:
-    IteratorLinkCell() : m_Np(0), m_Nc(0), m_cur_idx(LINK_CELL_TERMINATOR), m_cell(0) {}
+    IteratorLinkCell() : m_cell_begin(0), m_cell_end(0), m_cur_pos(0), m_cur_idx(LINK_CELL_TERMINATOR) {}
 
-    IteratorLinkCell(const util::ManagedArray<unsigned int> cell_list, unsigned int Np, unsigned int Nc,
-                     unsigned int cell)
-        : m_cell_list(cell_list), m_Np(Np), m_Nc(Nc)
-    {
-        m_cell = cell;
-        m_cur_idx = m_Np + cell;
-    }
+    IteratorLinkCell(const util::ManagedArray<unsigned int> sorted_indices, unsigned int cell_begin,
+                     unsigned int cell_end)
+        : m_sorted_indices(sorted_indices), m_cell_begin(cell_begin), m_cell_end(cell_end),
+          m_cur_pos(cell_begin), m_cur_idx(0)
+    {}
 
     //! Copy the position of rhs into this object
     void copy(const IteratorLinkCell& rhs);
@@ -75,11 +76,11 @@ public:
     unsigned int begin();
 
 private:
-    util::ManagedArray<unsigned int> m_cell_list; //!< The cell list
-    unsigned int m_Np;                            //!< Number of particles in the cell list
-    unsigned int m_Nc;                            //!< Number of cells in the cell list
-    unsigned int m_cur_idx;                       //!< Current index
-    unsigned int m_cell;                          //!< Cell being considered
+    util::ManagedArray<unsigned int> m_sorted_indices; //!< The point indices sorted by cell
+    unsigned int m_cell_begin;                         //!< First position of the cell in m_sorted_indices
+    unsigned int m_cell_end;                           //!< One past the last position of the cell
+    unsigned int m_cur_pos;                            //!< Position of the next particle to return
+    unsigned int m_cur_idx;                            //!< Current index
 };
 
 //! Iterates over sets of shells in a cell list
@@ -147,6 +148,113 @@ private:
     bool m_is2D;     //!< true if the cell list is 2D
 };
 
+//! Set of cell offsets that must be searched to find neighbors within a given distance
+/*! Ball queries on a LinkCell need to search every cell that may contain
+ *  points within r_max of the query point. Since this set of cells only
+ *  depends on the query distance and the cell geometry, it is computed once as
+ *  a stencil of integer cell offsets relative to the cell of the query point
+ *  and then reused for every query point.
+ *
+ *  Offsets are only included if the minimum distance between the central cell
+ *  and the offset cell is smaller than r_max. If the stencil would wrap around
+ *  the periodic box along some dimension, that dimension instead lists every
+ *  cell exactly once, so no cell is ever visited twice by the same query point.
+ *  For each query point, minDistanceSq provides a lower bound on the distance
+ *  to any point in an offset cell, so cells beyond r_max can be skipped.
+ *
+ *  The central cell is always the first offset in the stencil.
+ *
+ *  To find each pair of points only once, the stencil also provides a half
+ *  stencil that contains one of each pair of offsets that are mirror images of
+ *  each other. Offsets that are their own mirror image, like the central cell,
+ *  are listed first in the half stencil; pairs found through them must
+ *  additionally be ordered by point index.
+ */
+class CellStencil
+{
+public:
+    //! Default constructor
+    CellStencil() : m_num_ordered_half_offsets(0), m_wrapped(false, false, false), m_orthogonal(true) {}
+
+    //! Constructor
+    /*! \param box The box of the cell list.
+     *  \param celldim The number of cells in each dimension.
+     *  \param r_max The query distance.
+     */
+    CellStencil(const box::Box& box, const vec3<unsigned int>& celldim, float r_max);
+
+    //! Get the cell offsets of the stencil
+    const std::vector<vec3<int>>& getOffsets() const
+    {
+        return m_offsets;
+    }
+
+    //! Get the cell offsets of the half stencil
+    const std::vector<vec3<int>>& getHalfOffsets() const
+    {
+        return m_half_offsets;
+    }
+
+    //! Get the number of leading half stencil offsets whose pairs must be ordered by point index
+    unsigned int getNumOrderedHalfOffsets() const
+    {
+        return m_num_ordered_half_offsets;
+    }
+
+    //! Compute a lower bound on the squared distance from a point to any point in an offset cell.
+    /*! \param offset The cell offset from the stencil.
+     *  \param cell_fraction The position of the point within its own cell in
+     *         units of cells along each dimension, each component in [0, 1).
+     */
+    float minDistanceSq(const vec3<int>& offset, const vec3<float>& cell_fraction) const
+    {
+        const float gap_x = axisGap(offset.x, cell_fraction.x, m_cell_widths.x, m_wrapped.x);
+        const float gap_y = axisGap(offset.y, cell_fraction.y, m_cell_widths.y, m_wrapped.y);
+        const float gap_z = axisGap(offset.z, cell_fraction.z, m_cell_widths.z, m_wrapped.z);
+        return combineGaps(gap_x, gap_y, gap_z, m_orthogonal);
+    }
+
+    //! Compute the minimum separation along one dimension between a point and an offset cell.
+    /*! The separation is measured between lattice planes, so it is a lower
+     *  bound on the distance for any box. A small slack accounts for the
+     *  finite precision of the cell assignment of points near cell faces.
+     */
+    static float axisGap(int offset, float cell_fraction, float cell_width, bool wrapped)
+    {
+        if (wrapped || offset == 0)
+        {
+            return 0;
+        }
+        const float gap_cells = (offset > 0) ? (offset - cell_fraction) : (-offset - 1 + cell_fraction);
+        return std::max(gap_cells - CELL_FRACTION_SLACK, float(0)) * cell_width;
+    }
+
+    //! Combine the separations along each dimension into a bound on the squared distance.
+    /*! In orthorhombic boxes the lattice planes are orthogonal, so the
+     *  separations add in quadrature. Otherwise, only the largest separation is
+     *  guaranteed to be a lower bound.
+     */
+    static float combineGaps(float gap_x, float gap_y, float gap_z, bool orthogonal)
+    {
+        if (orthogonal)
+        {
+            return gap_x * gap_x + gap_y * gap_y + gap_z * gap_z;
+        }
+        const float max_gap = std::max(gap_x, std::max(gap_y, gap_z));
+        return max_gap * max_gap;
+    }
+
+private:
+    static const float CELL_FRACTION_SLACK; //!< Tolerance in cell units for points near cell faces.
+
+    std::vector<vec3<int>> m_offsets;      //!< The cell offsets to search.
+    std::vector<vec3<int>> m_half_offsets; //!< The cell offsets to search for unique pairs.
+    unsigned int m_num_ordered_half_offsets; //!< Number of half offsets that are their own mirror image.
+    vec3<float> m_cell_widths;        //!< The distance between cell faces in each dimension.
+    vec3<bool> m_wrapped;             //!< Whether the stencil covers every cell in each dimension.
+    bool m_orthogonal;                //!< Whether the box is orthorhombic.
+};
+
 //! Computes a cell id for each particle and a link cell data structure for iterating through it
 /*! For simplicity in only needing a small number of arrays, the link cell
  *  algorithm is used to generate and store the cell list data for particles.
@@ -165,8 +273,14 @@ private:
  *  an arbitrary point.
 
  *  <b>Data structures:</b><br>
- *  The internal data structure used in LinkCell is a linked list of particle
- *  indices. See IteratorLinkCell for information on how to iterate through these.
+ *  The cell list is stored in a compact layout built with a parallel counting
+ *  sort. The indices of the points are sorted by cell (and by index within
+ *  each cell), the points of cell c occupying positions
+ *  [cell_offsets[c], cell_offsets[c + 1]) of the sorted arrays. A copy of the
+ *  point positions in the same order is stored alongside the indices, so that
+ *  the points of a cell can be streamed from contiguous memory. See
+ *  IteratorLinkCell for a view of a single cell that is compatible with the
+ *  classic linked list interface.
 
  *  <b>2D:</b><br>
  *  LinkCell properly handles 2D boxes. When a 2D box is handed to LinkCell,
@@ -193,6 +307,12 @@ public:
     //! Compute cell id from cell coordinates
     unsigned int getCellIndex(const vec3<int> cellCoord) const;
 
+    //! Get the number of cells along each dimension
+    const vec3<unsigned int>& getCellDims() const
+    {
+        return m_celldim;
+    }
+
     //! Get the number of cells
     unsigned int getNumCells() const
     {
@@ -221,10 +341,37 @@ public:
     //! Compute cell coordinates for a given position
     vec3<unsigned int> getCellCoord(const vec3<float> p) const;
 
+    //! Compute cell coordinates for a given position and the position within that cell
+    /*! \param p The position.
+     *  \param cell_fraction Output position within the cell in units of cells, each component in [0, 1).
+     */
+    vec3<unsigned int> getCellCoord(const vec3<float> p, vec3<float>& cell_fraction) const;
+
+    //! Get the stencil of cells to search for ball queries with a given r_max
+    const CellStencil& getStencil(float r_max) const;
+
     //! Iterate over particles in a cell
     iteratorcell itercell(unsigned int cell) const
     {
-        return iteratorcell(m_cell_list, m_n_points, getNumCells(), cell);
+        return iteratorcell(m_sorted_indices, m_cell_offsets[cell], m_cell_offsets[cell + 1]);
+    }
+
+    //! Get the offsets of the cells into the cell-sorted arrays (of size getNumCells() + 1)
+    const util::ManagedArray<unsigned int>& getCellOffsets() const
+    {
+        return m_cell_offsets;
+    }
+
+    //! Get the point indices sorted by cell
+    const util::ManagedArray<unsigned int>& getSortedIndices() const
+    {
+        return m_sorted_indices;
+    }
+
+    //! Get the point positions sorted by cell
+    const util::ManagedArray<vec3<float>>& getSortedPoints() const
+    {
+        return m_sorted_points;
     }
 
     //! Get a list of neighbors to a cell
@@ -233,6 +380,17 @@ public:
     //! Compute the cell list
     void computeCellList(const vec3<float>* points, unsigned int n_points);
 
+    //! Update the cell list for new positions of the points
+    /*! Only the points whose cell changed are moved between cells, and the
+     *  existing arrays and cached cell neighbors and stencils are reused since
+     *  the box and cell width are unchanged. If the number of points changed,
+     *  the cell list is recomputed from scratch.
+     *
+     *  \param points The new point positions.
+     *  \param n_points The number of points.
+     */
+    void update(const vec3<float>* points, unsigned int n_points);
+
     //! Implementation of per-particle query for LinkCell (see NeighborQuery.h for documentation).
     /*! \param query_point The point to find neighbors for.
      *  \param n_query_points The number of query points.
@@ -241,19 +399,34 @@ public:
     virtual std::shared_ptr<NeighborQueryPerPointIterator>
     querySingle(const vec3<float> query_point, unsigned int query_point_idx, QueryArgs args) const;
 
+    //! Implementation of batched query for LinkCell (see NeighborQuery.h for documentation).
+    virtual void queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                            QueryArgs args, std::vector<NeighborBond>& bonds) const;
+
 private:
     //! Helper function to compute cell neighbors
     const std::vector<unsigned int>& computeCellNeighbors(unsigned int cell) const;
 
+    //! Find all neighbors of a block of query points within a ball without per-point iterators.
+    void queryBallBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                        const QueryArgs& args, std::vector<NeighborBond>& bonds) const;
+
     unsigned int m_n_points;      //!< Number of particles last placed into the cell list
     unsigned int m_Nc;            //!< Number of cells last used
     float m_cell_width;           //!< Minimum necessary cell width cutoff
     vec3<unsigned int> m_celldim; //!< Cell dimensions
     unsigned int m_size;          //!< The size of cell list.
 
-    util::ManagedArray<unsigned int> m_cell_list; //!< The cell list last computed
+    util::ManagedArray<unsigned int> m_point_cells;    //!< The cell of each point
+    util::ManagedArray<unsigned int> m_cell_offsets;   //!< Start of each cell in the sorted arrays
+    util::ManagedArray<unsigned int> m_sorted_indices; //!< Point indices sorted by cell
+    util::ManagedArray<vec3<float>> m_sorted_points;   //!< Point positions sorted by cell
+    util::ManagedArray<unsigned int> m_update_offsets; //!< Scratch cell offsets used by update
+    util::ManagedArray<unsigned int> m_update_indices; //!< Scratch sorted point indices used by update
     typedef tbb::concurrent_hash_map<unsigned int, std::vector<unsigned int>> CellNeighbors;
     mutable CellNeighbors m_cell_neighbors; //!< Hash map of cell neighbors for each cell
+    typedef tbb::concurrent_hash_map<float, CellStencil> CellStencils;
+    mutable CellStencils m_cell_stencils; //!< Hash map of ball query stencils for each r_max
 };
 
 //! Parent class of LinkCell iterators that knows how to traverse general cell-linked list structures.
@@ -261,28 +434,32 @@ class LinkCellIterator : public NeighborQueryPerPointIterator
 {
 public:
     //! Constructor
-    /*! The initial state is to search shell 0, the current cell. We then
-     *  iterate outwards from there.
+    /*! The initial state is to search the current cell. We then iterate
+     *  outwards from there.
      */
     LinkCellIterator(const LinkCell* neighbor_query, const vec3<float> query_point,
                      unsigned int query_point_idx, float r_max, float r_min, bool exclude_ii)
         : NeighborQueryPerPointIterator(neighbor_query, query_point, query_point_idx, r_max, r_min,
                                         exclude_ii),
-          m_linkcell(neighbor_query), m_neigh_cell_iter(0, neighbor_query->getBox().is2D()),
-          m_cell_iter(m_linkcell->itercell(m_linkcell->getCell(m_query_point)))
-    {}
+          m_linkcell(neighbor_query)
+    {
+        setCell(m_linkcell->getCell(m_query_point));
+    }
 
     //! Empty Destructor
     virtual ~LinkCellIterator() {}
 
 protected:
+    //! Start iterating over the points of the given cell.
+    void setCell(unsigned int cell)
+    {
+        m_cell_pos = m_linkcell->getCellOffsets().get()[cell];
+        m_cell_end = m_linkcell->getCellOffsets().get()[cell + 1];
+    }
+
     const LinkCell* m_linkcell; //!< Link to the LinkCell object
-    IteratorCellShell
-        m_neigh_cell_iter; //!< The shell iterator indicating how far out we're currently searching.
-    LinkCell::iteratorcell
-        m_cell_iter; //!< The cell iterator indicating which cell we're currently searching.
-    std::unordered_set<unsigned int>
-        m_searched_cells; //!< Set of cells that have already been searched by the cell shell iterator.
+    unsigned int m_cell_pos;    //!< Position in the cell-sorted arrays of the next point to search.
+    unsigned int m_cell_end;    //!< End of the cell currently being searched in the cell-sorted arrays.
 };
 
 //! Iterator that gets specified numbers of nearest neighbors from LinkCell tree structures.
@@ -294,7 +471,8 @@ public:
                           unsigned int query_point_idx, unsigned int num_neighbors, float r_max, float r_min,
                           bool exclude_ii)
         : LinkCellIterator(neighbor_query, query_point, query_point_idx, r_max, r_min, exclude_ii),
-          m_count(0), m_num_neighbors(num_neighbors)
+          m_neigh_cell_iter(0, neighbor_query->getBox().is2D()), m_count(0), m_num_neighbors(num_neighbors),
+          m_searched(false)
     {}
 
     //! Empty Destructor
@@ -304,9 +482,22 @@ public:
     virtual NeighborBond next();
 
 protected:
+    //! Find the nearest neighbors by searching shells of cells outwards from the query point.
+    /*! The closest bonds are kept in a bounded heap. Cells that cannot
+     *  contain a point closer than the current k-th nearest neighbor are
+     *  skipped, and the search stops at the first shell of cells that is
+     *  entirely farther away.
+     */
+    void findNeighbors();
+
+    IteratorCellShell
+        m_neigh_cell_iter; //!< The shell iterator indicating how far out we're currently searching.
+    std::unordered_set<unsigned int>
+        m_searched_cells;  //!< Set of cells that have already been searched by the cell shell iterator.
     unsigned int m_count;                          //!< Number of neighbors returned for the current point.
     unsigned int m_num_neighbors;                  //!< Number of nearest neighbors to find
     std::vector<NeighborBond> m_current_neighbors; //!< The current set of found neighbors.
+    bool m_searched;                               //!< Whether the neighbors have been found.
 };
 
 //! Iterator that gets neighbors in a ball of size r using LinkCell tree structures.
@@ -316,19 +507,13 @@ public:
     //! Constructor
     LinkCellQueryBallIterator(const LinkCell* neighbor_query, const vec3<float> query_point,
                               unsigned int query_point_idx, float r_max, float r_min, bool exclude_ii)
-        : LinkCellIterator(neighbor_query, query_point, query_point_idx, r_max, r_min, exclude_ii)
+        : LinkCellIterator(neighbor_query, query_point, query_point_idx, r_max, r_min, exclude_ii),
+          m_stencil(neighbor_query->getStencil(r_max)), m_stencil_idx(1)
     {
-        // Upon querying, if the search radius is equal to the cell width, we
-        // can guarantee that we don't need to search the cell shell past the
-        // query radius. For simplicity, we store this value as an integer.
-        if (m_r_max == neighbor_query->getCellWidth())
-        {
-            m_extra_search_width = 0;
-        }
-        else
-        {
-            m_extra_search_width = 1;
-        }
+        // The base class starts with the central cell, which is always the
+        // first offset of the stencil.
+        const vec3<unsigned int> point_cell(m_linkcell->getCellCoord(m_query_point, m_cell_fraction));
+        m_point_cell = vec3<int>(point_cell.x, point_cell.y, point_cell.z);
     }
 
     //! Empty Destructor
@@ -338,7 +523,10 @@ public:
     virtual NeighborBond next();
 
 protected:
-    int m_extra_search_width; //!< The extra shell distance to search, always 0 or 1.
+    const CellStencil& m_stencil; //!< The stencil of cell offsets to search.
+    unsigned int m_stencil_idx;   //!< Index of the next stencil offset to search.
+    vec3<int> m_point_cell;       //!< Cell coordinates of the query point.
+    vec3<float> m_cell_fraction;  //!< Position of the query point within its cell.
 };
 }; }; // end namespace freud::locality
 
@@ -1,7 +1,9 @@
 #ifndef NEIGHBOR_COMPUTE_FUNCTIONAL_H
 #define NEIGHBOR_COMPUTE_FUNCTIONAL_H
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "AABBQuery.h"
 #include "NeighborList.h"
@@ -35,57 +37,139 @@ inline vec3<float> bondVector(const NeighborBond& nb, const NeighborQuery* nq,
     return nq->getBox().wrap((*nq)[nb.point_idx] - query_points[nb.query_point_idx]);
 }
 
+//! Check whether the neighbors of a computation can be found as unique pairs.
+/*! Computations whose contribution from a bond is symmetric in its two points
+ *  can halve their pair work by finding each pair of points only once (see
+ *  QueryArgs::unique_pairs) and accounting for both directions of the bond at
+ *  once. This is only possible if no NeighborList is provided and the points
+ *  are queried against themselves with a ball query.
+ */
+inline bool canFindUniquePairs(const NeighborQuery* nq, const vec3<float>* query_points,
+                               unsigned int num_query_points, const QueryArgs& qargs,
+                               const NeighborList* nlist)
+{
+    const bool is_ball = (qargs.mode == QueryArgs::ball)
+        || (qargs.mode == QueryArgs::none && qargs.num_neighbors == QueryArgs::DEFAULT_NUM_NEIGHBORS
+            && qargs.r_max != QueryArgs::DEFAULT_R_MAX);
+    return (nlist == NULL) && is_ball && (query_points == nq->getPoints())
+        && (num_query_points == nq->getNPoints());
+}
+
 //! Implementation of per-point finding logic for NeighborList objects.
 /*! This class provides a concrete implementation of the per-point neighbor
  *  finding interface specified by the NeighborPerPointIterator. In particular,
- *  it includes the logic for finding neighbors within a NeighborList by using
- *  the find_first_index method to initialize a start index and looping over all
- *  neighbors in the NeighborList.
+ *  it includes the logic for finding neighbors within a NeighborList by
+ *  looping over the bonds in the segment of the query point. It only holds
+ *  pointers to the bond arrays of the NeighborList, so it can be cheaply
+ *  reset to point to the bonds of a different query point and reused.
  */
 class NeighborListPerPointIterator : public NeighborPerPointIterator
 {
 public:
+    NeighborListPerPointIterator()
+        : NeighborPerPointIterator(0), m_point_indices(NULL), m_distances(NULL), m_weights(NULL),
+          m_current_index(0), m_end_index(0), m_finished(true)
+    {}
+
     NeighborListPerPointIterator(const NeighborList* nlist, size_t point_index)
-        : NeighborPerPointIterator(point_index), m_nlist(nlist)
     {
-        m_current_index = m_nlist->find_first_index(point_index);
-        m_finished = m_current_index == m_nlist->getNumBonds();
-        if (!m_finished)
-        {
-            m_returned_point_index = m_nlist->getNeighbors()(m_current_index, 0);
-        }
+        reset(nlist, point_index);
     }
 
     ~NeighborListPerPointIterator() {}
 
+    //! Point the iterator at the bonds of the given query point.
+    void reset(const NeighborList* nlist, size_t point_index)
+    {
+        m_query_point_idx = point_index;
+        m_point_indices = nlist->getPointIndices().get();
+        m_distances = nlist->getDistances().get();
+        m_weights = nlist->getWeights().get();
+        m_current_index = nlist->find_first_index(point_index);
+        m_end_index = nlist->find_first_index(point_index + 1);
+        m_finished = false;
+    }
+
     virtual NeighborBond next()
     {
-        if (m_current_index == m_nlist->getNumBonds())
+        if (m_current_index == m_end_index)
         {
             m_finished = true;
             return ITERATOR_TERMINATOR;
         }
 
-        NeighborBond nb = NeighborBond(
-            m_nlist->getNeighbors()(m_current_index, 0), m_nlist->getNeighbors()(m_current_index, 1),
-            m_nlist->getDistances()[m_current_index], m_nlist->getWeights()[m_current_index]);
+        NeighborBond nb = NeighborBond(m_query_point_idx, m_point_indices[m_current_index],
+                                       m_distances[m_current_index], m_weights[m_current_index]);
         ++m_current_index;
-        m_returned_point_index = nb.query_point_idx;
         return nb;
     }
 
     virtual bool end()
     {
-        return (m_returned_point_index != m_query_point_idx) || m_finished;
+        return m_finished;
     }
 
 private:
-    const NeighborList* m_nlist;
-    size_t m_current_index;
-    size_t m_returned_point_index;
-    bool m_finished;
+    const unsigned int* m_point_indices; //!< The point index of each bond of the NeighborList.
+    const float* m_distances;            //!< The distance of each bond of the NeighborList.
+    const float* m_weights;              //!< The weight of each bond of the NeighborList.
+    unsigned int m_current_index;        //!< The next bond to return.
+    unsigned int m_end_index;            //!< One past the last bond of the query point.
+    bool m_finished;                     //!< Flag to indicate that iteration is complete.
 };
 
+//! Implementation of per-point iteration over a contiguous range of bonds.
+/*! This class provides a concrete implementation of the per-point neighbor
+ *  finding interface for bonds that have already been found, e.g. by a
+ *  batched query (see NeighborQuery::queryBatch). It does not own the bonds,
+ *  so it can be cheaply reset to point to the bonds of a different query
+ *  point and reused.
+ */
+class NeighborBondPerPointIterator : public NeighborPerPointIterator
+{
+public:
+    NeighborBondPerPointIterator()
+        : NeighborPerPointIterator(0), m_current(NULL), m_end(NULL), m_finished(true)
+    {}
+
+    ~NeighborBondPerPointIterator() {}
+
+    //! Point the iterator at the bonds in [begin, end) of the given query point.
+    void reset(unsigned int query_point_idx, const NeighborBond* begin, const NeighborBond* end)
+    {
+        m_query_point_idx = query_point_idx;
+        m_current = begin;
+        m_end = end;
+        m_finished = false;
+    }
+
+    virtual NeighborBond next()
+    {
+        if (m_current == m_end)
+        {
+            m_finished = true;
+            return ITERATOR_TERMINATOR;
+        }
+        return *(m_current++);
+    }
+
+    virtual bool end()
+    {
+        return m_finished;
+    }
+
+private:
+    const NeighborBond* m_current; //!< The next bond to return.
+    const NeighborBond* m_end;     //!< One past the last bond of the current query point.
+    bool m_finished;               //!< Flag to indicate that iteration is complete.
+};
+
+//! Number of query points whose bonds are found in one batched query.
+/*! Batching bounds the size of the bond buffers used by the looping functions
+ *  below while still amortizing the per-query overhead.
+ */
+const unsigned int NEIGHBOR_QUERY_BATCH_SIZE = 256;
+
 //! Wrapper iterating looping over NeighborQuery or NeighborList.
 /*! This function dynamically determines whether or not the provided
  *  NeighborList is valid. If it is, it applies the provide compute function to
@@ -121,11 +205,15 @@ void loopOverNeighborsIterator(const NeighborQuery* neighbor_query, const vec3<f
         util::forLoopWrapper(
             0, n_query_points,
             [=](size_t begin, size_t end) {
+                NeighborListPerPointIterator nlist_iter;
+                // The compute function does not take ownership of the
+                // iterator, so we hand it a non-owning shared pointer.
+                std::shared_ptr<NeighborListPerPointIterator> it(
+                    std::shared_ptr<NeighborListPerPointIterator>(), &nlist_iter);
                 for (size_t i = begin; i != end; ++i)
                 {
-                    std::shared_ptr<NeighborListPerPointIterator> niter
-                        = std::make_shared<NeighborListPerPointIterator>(nlist, i);
-                    cf(i, niter);
+                    nlist_iter.reset(nlist, i);
+                    cf(i, it);
                 }
             },
             parallel);
@@ -135,14 +223,38 @@ void loopOverNeighborsIterator(const NeighborQuery* neighbor_query, const vec3<f
         std::shared_ptr<NeighborQueryIterator> iter
             = neighbor_query->query(query_points, n_query_points, qargs);
 
-        // iterate over the query object in parallel
+        // iterate over the query object in parallel, finding the bonds of
+        // blocks of query points at once and then handing out per-point
+        // iterators over those bonds
         util::forLoopWrapper(
             0, n_query_points,
             [=](size_t begin, size_t end) {
-                for (size_t i = begin; i != end; ++i)
+                std::vector<NeighborBond> bonds;
+                NeighborBondPerPointIterator bond_iter;
+                // The compute function does not take ownership of the
+                // iterator, so we hand it a non-owning shared pointer.
+                std::shared_ptr<NeighborBondPerPointIterator> it(
+                    std::shared_ptr<NeighborBondPerPointIterator>(), &bond_iter);
+                for (size_t batch_begin = begin; batch_begin < end; batch_begin += NEIGHBOR_QUERY_BATCH_SIZE)
                 {
-                    std::shared_ptr<NeighborQueryPerPointIterator> it = iter->query(i);
-                    cf(i, it);
+                    const size_t batch_end = std::min(batch_begin + NEIGHBOR_QUERY_BATCH_SIZE, end);
+                    bonds.clear();
+                    iter->queryBatch(batch_begin, batch_end, bonds);
+
+                    // Bonds are grouped by query point in increasing order.
+                    const NeighborBond* bond = bonds.data();
+                    const NeighborBond* bonds_end = bonds.data() + bonds.size();
+                    for (size_t i = batch_begin; i != batch_end; ++i)
+                    {
+                        const NeighborBond* point_bonds_end = bond;
+                        while (point_bonds_end != bonds_end && point_bonds_end->query_point_idx == i)
+                        {
+                            ++point_bonds_end;
+                        }
+                        bond_iter.reset(i, bond, point_bonds_end);
+                        cf(i, it);
+                        bond = point_bonds_end;
+                    }
                 }
             },
             parallel);
@@ -178,14 +290,19 @@ void loopOverNeighbors(const NeighborQuery* neighbor_query, const vec3<float>* q
     // check if nlist exists
     if (nlist != NULL)
     {
+        const util::ManagedArray<unsigned int>& segments = nlist->getSegments();
+        const util::ManagedArray<unsigned int>& point_indices = nlist->getPointIndices();
+        const util::ManagedArray<float>& distances = nlist->getDistances();
+        const util::ManagedArray<float>& weights = nlist->getWeights();
         util::forLoopWrapper(
-            0, nlist->getNumBonds(),
-            [=](size_t begin, size_t end) {
-                for (size_t bond = begin; bond != end; ++bond)
+            0, nlist->getNumQueryPoints(),
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i != end; ++i)
                 {
-                    const NeighborBond nb(nlist->getNeighbors()(bond, 0), nlist->getNeighbors()(bond, 1),
-                                          nlist->getDistances()[bond], nlist->getWeights()[bond]);
-                    cf(nb);
+                    for (unsigned int bond = segments[i]; bond != segments[i + 1]; ++bond)
+                    {
+                        cf(NeighborBond(i, point_indices[bond], distances[bond], weights[bond]));
+                    }
                 }
             },
             parallel);
@@ -195,19 +312,20 @@ void loopOverNeighbors(const NeighborQuery* neighbor_query, const vec3<float>* q
         std::shared_ptr<NeighborQueryIterator> iter
             = neighbor_query->query(query_points, n_query_points, qargs);
 
-        // iterate over the query object in parallel
+        // iterate over the query object in parallel, finding the bonds of
+        // blocks of query points at once
         util::forLoopWrapper(
             0, n_query_points,
             [&iter, &cf](size_t begin, size_t end) {
-                NeighborBond nb;
-                for (size_t i = begin; i != end; ++i)
+                std::vector<NeighborBond> bonds;
+                for (size_t batch_begin = begin; batch_begin < end; batch_begin += NEIGHBOR_QUERY_BATCH_SIZE)
                 {
-                    std::shared_ptr<NeighborQueryPerPointIterator> it = iter->query(i);
-                    nb = it->next();
-                    while (!it->end())
+                    const size_t batch_end = std::min(batch_begin + NEIGHBOR_QUERY_BATCH_SIZE, end);
+                    bonds.clear();
+                    iter->queryBatch(batch_begin, batch_end, bonds);
+                    for (const NeighborBond& nb : bonds)
                     {
                         cf(nb);
-                        nb = it->next();
                     }
                 }
             },
@@ -0,0 +1,123 @@
+// Copyright (c) 2010-2019 The Regents of the University of Michigan
+// This file is from the freud project, released under the BSD 3-Clause License.
+
+#ifndef NEIGHBOR_HEAP_H
+#define NEIGHBOR_HEAP_H
+
+#include <algorithm>
+#include <vector>
+
+#include "NeighborBond.h"
+
+/*! \file NeighborHeap.h
+    \brief Bounded heap of the nearest neighbors of a query point.
+*/
+
+namespace freud { namespace locality {
+
+//! Fixed-size max-heap of the nearest neighbor bonds found so far.
+/*! Nearest neighbor searches visit candidates in an arbitrary order. This
+ *  class keeps only the num_neighbors closest candidates, with the farthest
+ *  of them at the top of the heap, so each candidate costs O(log k) instead of
+ *  growing a list that must be sorted. Once the heap is full, the distance of
+ *  the farthest kept bond bounds the region that remains to be searched.
+ */
+class NeighborHeap
+{
+public:
+    //! Constructor
+    /*! \param num_neighbors The number of nearest neighbors to keep.
+     */
+    explicit NeighborHeap(unsigned int num_neighbors) : m_num_neighbors(num_neighbors)
+    {
+        m_bonds.reserve(num_neighbors);
+    }
+
+    //! Whether num_neighbors bonds have been found.
+    bool full() const
+    {
+        return m_bonds.size() >= m_num_neighbors;
+    }
+
+    //! Get the distance of the farthest bond kept.
+    /*! Only meaningful if the heap is not empty.
+     */
+    float maxDistance() const
+    {
+        return m_bonds.front().distance;
+    }
+
+    //! Discard all bonds, keeping the allocated storage.
+    void clear()
+    {
+        m_bonds.clear();
+    }
+
+    //! Offer a bond, keeping it if it is closer than the farthest bond kept.
+    void insert(const NeighborBond& bond)
+    {
+        if (!full())
+        {
+            m_bonds.push_back(bond);
+            std::push_heap(m_bonds.begin(), m_bonds.end());
+        }
+        else if (m_num_neighbors > 0 && bond < m_bonds.front())
+        {
+            std::pop_heap(m_bonds.begin(), m_bonds.end());
+            m_bonds.back() = bond;
+            std::push_heap(m_bonds.begin(), m_bonds.end());
+        }
+    }
+
+    //! Offer a bond to a point that may already be kept through another periodic image.
+    /*! Only the closest image of each point is kept. This requires a linear
+     *  search of the heap, so it should only be used when two images of a
+     *  point can both be closer than the farthest bond kept.
+     */
+    void insertClosestImage(const NeighborBond& bond)
+    {
+        for (std::vector<NeighborBond>::iterator it = m_bonds.begin(); it != m_bonds.end(); ++it)
+        {
+            if (it->point_idx == bond.point_idx)
+            {
+                if (bond < *it)
+                {
+                    *it = bond;
+                    std::make_heap(m_bonds.begin(), m_bonds.end());
+                }
+                return;
+            }
+        }
+        insert(bond);
+    }
+
+    //! Remove the bond to a point if it is kept.
+    void erase(unsigned int point_idx)
+    {
+        for (std::vector<NeighborBond>::iterator it = m_bonds.begin(); it != m_bonds.end(); ++it)
+        {
+            if (it->point_idx == point_idx)
+            {
+                m_bonds.erase(it);
+                std::make_heap(m_bonds.begin(), m_bonds.end());
+                return;
+            }
+        }
+    }
+
+    //! Move the kept bonds into a vector sorted by distance, emptying the heap.
+    void popSorted(std::vector<NeighborBond>& bonds)
+    {
+        std::sort_heap(m_bonds.begin(), m_bonds.end());
+        bonds.swap(m_bonds);
+        m_bonds.clear();
+    }
+
+private:
+    unsigned int m_num_neighbors;      //!< Number of nearest neighbors to keep.
+    std::vector<NeighborBond> m_bonds; //!< Heap of the closest bonds found so far.
+};
+
+}; }; // end namespace freud::locality
+
+#endif // NEIGHBOR_HEAP_H
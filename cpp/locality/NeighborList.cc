@@ -1,23 +1,30 @@
 // Copyright (c) 2010-2019 The Regents of the University of Michigan
 // This file is from the freud project, released under the BSD 3-Clause License.
 
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
 #include "NeighborList.h"
+#include "utils.h"
 
 namespace freud { namespace locality {
 
 NeighborList::NeighborList()
-    : m_num_query_points(0), m_num_points(0), m_neighbors({0, 2}), m_distances(0), m_weights(0),
-      m_segments_counts_updated(false)
+    : m_num_query_points(0), m_num_points(0), m_segments(1), m_point_indices(0), m_distances(0),
+      m_weights(0), m_neighbors_updated(false), m_counts_updated(false)
 {}
 
 NeighborList::NeighborList(unsigned int num_bonds)
-    : m_num_query_points(0), m_num_points(0), m_neighbors({num_bonds, 2}), m_distances(num_bonds),
-      m_weights(num_bonds), m_segments_counts_updated(false)
-{}
+    : m_num_query_points(0), m_num_points(0), m_segments(1), m_point_indices(num_bonds),
+      m_distances(num_bonds), m_weights(num_bonds), m_neighbors_updated(false), m_counts_updated(false)
+{
+    m_segments[0] = num_bonds;
+}
 
 NeighborList::NeighborList(const NeighborList& other)
     : m_num_query_points(other.m_num_query_points), m_num_points(other.m_num_points),
-      m_segments_counts_updated(false)
+      m_neighbors_updated(false), m_counts_updated(false)
 {
     copy(other);
 }
@@ -25,8 +32,38 @@ NeighborList::NeighborList(const NeighborList& other)
 NeighborList::NeighborList(unsigned int num_bonds, const unsigned int* query_point_index,
                            unsigned int num_query_points, const unsigned int* point_index,
                            unsigned int num_points, const float* distances, const float* weights)
-    : m_num_query_points(num_query_points), m_num_points(num_points), m_neighbors({num_bonds, 2}),
-      m_distances(num_bonds), m_weights(num_bonds), m_segments_counts_updated(false)
+    : m_num_query_points(num_query_points), m_num_points(num_points), m_segments(num_query_points + 1),
+      m_point_indices(num_bonds), m_distances(num_bonds), m_weights(num_bonds), m_neighbors_updated(false),
+      m_counts_updated(false)
+{
+    validateBonds(num_bonds, query_point_index, point_index);
+    computeSegments(num_bonds, [=](size_t bond) { return query_point_index[bond]; });
+    util::forLoopWrapper(0, num_bonds, [=](size_t begin, size_t end) {
+        std::copy(point_index + begin, point_index + end, m_point_indices.get() + begin);
+        std::copy(distances + begin, distances + end, m_distances.get() + begin);
+        std::copy(weights + begin, weights + end, m_weights.get() + begin);
+    });
+}
+
+NeighborList::NeighborList(const unsigned int* query_point_index, unsigned int num_query_points,
+                           const util::ManagedArray<unsigned int>& point_indices, unsigned int num_points,
+                           const util::ManagedArray<float>& distances,
+                           const util::ManagedArray<float>& weights)
+    : m_num_query_points(num_query_points), m_num_points(num_points), m_segments(num_query_points + 1),
+      m_point_indices(point_indices), m_distances(distances), m_weights(weights), m_neighbors_updated(false),
+      m_counts_updated(false)
+{
+    const unsigned int num_bonds = point_indices.size();
+    if (distances.size() != num_bonds || weights.size() != num_bonds)
+    {
+        throw std::invalid_argument("NeighborList arrays must all have the same number of bonds.");
+    }
+    validateBonds(num_bonds, query_point_index, point_indices.get());
+    computeSegments(num_bonds, [=](size_t bond) { return query_point_index[bond]; });
+}
+
+void NeighborList::validateBonds(unsigned int num_bonds, const unsigned int* query_point_index,
+                                 const unsigned int* point_index) const
 {
     unsigned int last_index(0);
     unsigned int index(0);
@@ -40,17 +77,13 @@ NeighborList::NeighborList(unsigned int num_bonds, const unsigned int* query_poi
                 "NeighborList query_point_index values must be less than num_query_points.");
         if (point_index[i] >= m_num_points)
             throw std::runtime_error("NeighborList point_index values must be less than num_points.");
-        m_neighbors(i, 0) = index;
-        m_neighbors(i, 1) = point_index[i];
-        m_weights[i] = weights[i];
-        m_distances[i] = distances[i];
         last_index = index;
     }
 }
 
 unsigned int NeighborList::getNumBonds() const
 {
-    return m_neighbors.shape()[0];
+    return m_point_indices.size();
 }
 
 unsigned int NeighborList::getNumQueryPoints() const
@@ -68,115 +101,261 @@ void NeighborList::setNumBonds(unsigned int num_bonds, unsigned int num_query_po
     resize(num_bonds);
     m_num_query_points = num_query_points;
     m_num_points = num_points;
-    m_segments_counts_updated = false;
+    m_segments.prepare(num_query_points + 1);
+    m_segments[num_query_points] = num_bonds;
+    m_neighbors_updated = false;
+    m_counts_updated = false;
 }
 
-void NeighborList::updateSegmentCounts() const
+void NeighborList::setBonds(const std::vector<NeighborBond>& bonds, unsigned int num_query_points,
+                            unsigned int num_points)
 {
-    if (!m_segments_counts_updated)
-    {
-        m_counts.prepare(m_num_query_points);
-        m_segments.prepare(m_num_query_points);
-        int index(-1);
-        int last_index(-1);
-        unsigned int counter(0);
-        for (unsigned int i = 0; i < getNumBonds(); i++)
+    const unsigned int num_bonds = bonds.size();
+    setNumBonds(num_bonds, num_query_points, num_points);
+    computeSegments(num_bonds, [&](size_t bond) { return bonds[bond].query_point_idx; });
+    util::forLoopWrapper(0, num_bonds, [&](size_t begin, size_t end) {
+        for (size_t bond = begin; bond < end; ++bond)
         {
-            index = m_neighbors(i, 0);
-            if (index != last_index)
-            {
-                m_segments[index] = i;
-                if (index > 0)
-                {
-                    if (last_index >= 0)
-                    {
-                        m_counts[last_index] = counter;
-                    }
-                    counter = 0;
-                }
-            }
-            last_index = index;
-            counter++;
+            m_point_indices[bond] = bonds[bond].point_idx;
+            m_distances[bond] = bonds[bond].distance;
+            m_weights[bond] = bonds[bond].weight;
         }
-        if (last_index >= 0)
+    });
+}
+
+template<typename QueryPointIndex>
+void NeighborList::computeSegments(unsigned int num_bonds, const QueryPointIndex& query_point_index)
+{
+    // Each bond that starts the bonds of a query point writes the segments
+    // of that query point and of all query points without bonds before it,
+    // so every segment is written exactly once.
+    util::forLoopWrapper(0, num_bonds, [&](size_t begin, size_t end) {
+        for (size_t bond = begin; bond < end; ++bond)
         {
-            m_counts[last_index] = counter;
+            const unsigned int i = query_point_index(bond);
+            const unsigned int first = (bond == 0) ? 0 : query_point_index(bond - 1) + 1;
+            for (unsigned int j = first; j <= i; ++j)
+            {
+                m_segments[j] = bond;
+            }
         }
-        m_segments_counts_updated = true;
+    });
+    const unsigned int first = (num_bonds == 0) ? 0 : query_point_index(num_bonds - 1) + 1;
+    for (unsigned int j = first; j <= m_num_query_points; ++j)
+    {
+        m_segments[j] = num_bonds;
     }
+    m_neighbors_updated = false;
+    m_counts_updated = false;
 }
 
-unsigned int NeighborList::filter(const bool* filt)
+void NeighborList::updateNeighbors() const
 {
-    // number of good (unfiltered-out) elements so far
-    unsigned int num_good(0);
-    const unsigned int old_size(getNumBonds());
+    if (!m_neighbors_updated)
+    {
+        m_neighbors.prepare({getNumBonds(), 2});
+        unsigned int* neighbors = m_neighbors.get();
+        util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                for (unsigned int bond = m_segments[i]; bond < m_segments[i + 1]; ++bond)
+                {
+                    neighbors[2 * bond] = i;
+                    neighbors[2 * bond + 1] = m_point_indices[bond];
+                }
+            }
+        });
+        m_neighbors_updated = true;
+    }
+}
 
-    for (unsigned int i(0); i < old_size; ++i)
+void NeighborList::updateCounts() const
+{
+    if (!m_counts_updated)
     {
-        if (filt[i])
-        {
-            m_neighbors(num_good, 0) = m_neighbors(i, 0);
-            m_neighbors(num_good, 1) = m_neighbors(i, 1);
-            m_weights[num_good] = m_weights[i];
-            m_distances[num_good] = m_distances[i];
-            ++num_good;
-        }
+        m_counts.prepare(m_num_query_points);
+        util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                m_counts[i] = m_segments[i + 1] - m_segments[i];
+            }
+        });
+        m_counts_updated = true;
     }
-    resize(num_good);
-    return old_size - num_good;
+}
+
+unsigned int NeighborList::filter(const bool* filt)
+{
+    return filterBonds([=](unsigned int bond) { return filt[bond]; });
 }
 
 unsigned int NeighborList::filter_r(float r_max, float r_min)
 {
-    // Can't use vector<bool> because that is specialized for compact storage
-    std::unique_ptr<bool[]> dist_filter(new bool[getNumBonds()]);
-    for (unsigned int i(0); i < getNumBonds(); ++i)
+    const float* distances = m_distances.get();
+    return filterBonds(
+        [=](unsigned int bond) { return distances[bond] >= r_min && distances[bond] < r_max; });
+}
+
+template<typename KeepBond> unsigned int NeighborList::filterBonds(const KeepBond& keep_bond)
+{
+    const unsigned int old_size(getNumBonds());
+
+    // Count the bonds kept for each query point in parallel. A prefix sum of
+    // the counts gives the new segments; it is computed serially because
+    // there are far fewer query points than bonds.
+    std::vector<unsigned int> new_segments(m_num_query_points + 1, 0);
+    util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            unsigned int num_kept(0);
+            for (unsigned int bond = m_segments[i]; bond < m_segments[i + 1]; ++bond)
+            {
+                num_kept += keep_bond(bond) ? 1 : 0;
+            }
+            new_segments[i + 1] = num_kept;
+        }
+    });
+    std::partial_sum(new_segments.begin(), new_segments.end(), new_segments.begin());
+    const unsigned int num_good(new_segments[m_num_query_points]);
+    if (num_good == old_size)
     {
-        dist_filter[i] = (m_distances[i] >= r_min && m_distances[i] < r_max);
+        return 0;
     }
-    return filter(dist_filter.get());
+
+    // Copy the kept bonds of each query point to their new segment. The
+    // bonds are compacted into new arrays because the segments of different
+    // threads could otherwise overlap the bonds other threads still read.
+    util::ManagedArray<unsigned int> new_point_indices(num_good);
+    util::ManagedArray<float> new_distances(num_good);
+    util::ManagedArray<float> new_weights(num_good);
+    util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            unsigned int new_bond(new_segments[i]);
+            for (unsigned int bond = m_segments[i]; bond < m_segments[i + 1]; ++bond)
+            {
+                if (keep_bond(bond))
+                {
+                    new_point_indices[new_bond] = m_point_indices[bond];
+                    new_distances[new_bond] = m_distances[bond];
+                    new_weights[new_bond] = m_weights[bond];
+                    ++new_bond;
+                }
+            }
+        }
+    });
+
+    std::copy(new_segments.begin(), new_segments.end(), m_segments.get());
+    m_point_indices = new_point_indices;
+    m_distances = new_distances;
+    m_weights = new_weights;
+    m_neighbors_updated = false;
+    m_counts_updated = false;
+    return old_size - num_good;
 }
 
 unsigned int NeighborList::find_first_index(unsigned int i) const
 {
-    if (getNumBonds())
-        return bisection_search(i, 0, getNumBonds()) + (i > m_neighbors(0, 0));
+    if (i < m_num_query_points)
+        return m_segments[i];
     else
-        return 0;
+        return getNumBonds();
 }
 
 void NeighborList::resize(unsigned int num_bonds)
 {
-    auto new_neighbors = util::ManagedArray<unsigned int>({num_bonds, 2});
-    auto new_distances = util::ManagedArray<float>(num_bonds);
-    auto new_weights = util::ManagedArray<float>(num_bonds);
-
-    // On shrinking resizes, keep existing data.
     if (num_bonds <= getNumBonds())
     {
-        for (unsigned int i = 0; i < num_bonds; i++)
+        // On shrinking resizes, keep existing data in place along with the
+        // bonds of each query point that still fit.
+        m_point_indices.shrink(num_bonds);
+        m_distances.shrink(num_bonds);
+        m_weights.shrink(num_bonds);
+        util::forLoopWrapper(0, m_segments.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                m_segments[i] = std::min(m_segments[i], num_bonds);
+            }
+        });
+    }
+    else
+    {
+        // Otherwise, all bonds are reset and belong to the last query point,
+        // as after setNumBonds.
+        m_point_indices = util::ManagedArray<unsigned int>(num_bonds);
+        m_distances = util::ManagedArray<float>(num_bonds);
+        m_weights = util::ManagedArray<float>(num_bonds);
+        std::fill(m_segments.get(), m_segments.get() + m_segments.size(), 0);
+        if (m_segments.size() > 0)
         {
-            new_neighbors(i, 0) = m_neighbors(i, 0);
-            new_neighbors(i, 1) = m_neighbors(i, 1);
-            new_distances[i] = m_distances[i];
-            new_weights[i] = m_weights[i];
+            m_segments[m_segments.size() - 1] = num_bonds;
         }
     }
-
-    m_neighbors = new_neighbors;
-    m_distances = new_distances;
-    m_weights = new_weights;
-    m_segments_counts_updated = false;
+    m_neighbors_updated = false;
+    m_counts_updated = false;
 }
 
 void NeighborList::copy(const NeighborList& other)
 {
     setNumBonds(other.getNumBonds(), other.getNumQueryPoints(), other.getNumPoints());
-    m_neighbors = other.m_neighbors.copy();
+    m_segments = other.m_segments.copy();
+    m_point_indices = other.m_point_indices.copy();
     m_weights = other.m_weights.copy();
     m_distances = other.m_distances.copy();
-    m_segments_counts_updated = false;
+    m_neighbors_updated = false;
+    m_counts_updated = false;
+}
+
+void NeighborList::mirror()
+{
+    if (m_num_query_points != m_num_points)
+    {
+        throw std::runtime_error("Only NeighborLists with the same query points and points can be mirrored.");
+    }
+
+    // Count the bonds of each query point in the mirrored list. Self bonds
+    // are their own mirror image, so they are not duplicated.
+    std::vector<unsigned int> segments(m_num_query_points + 1, 0);
+    for (unsigned int i = 0; i < m_num_query_points; ++i)
+    {
+        for (unsigned int bond = m_segments[i]; bond < m_segments[i + 1]; ++bond)
+        {
+            ++segments[i + 1];
+            if (i != m_point_indices[bond])
+            {
+                ++segments[m_point_indices[bond] + 1];
+            }
+        }
+    }
+    for (unsigned int i = 0; i < m_num_query_points; ++i)
+    {
+        segments[i + 1] += segments[i];
+    }
+
+    // Place each bond and its mirror image in the segments of their query
+    // points, then sort the (short) segments by point index.
+    std::vector<NeighborBond> bonds(segments[m_num_query_points]);
+    std::vector<unsigned int> cursors(segments.begin(), segments.end() - 1);
+    for (unsigned int i = 0; i < m_num_query_points; ++i)
+    {
+        for (unsigned int bond = m_segments[i]; bond < m_segments[i + 1]; ++bond)
+        {
+            const unsigned int j = m_point_indices[bond];
+            bonds[cursors[i]++] = NeighborBond(i, j, m_distances[bond], m_weights[bond]);
+            if (i != j)
+            {
+                bonds[cursors[j]++] = NeighborBond(j, i, m_distances[bond], m_weights[bond]);
+            }
+        }
+    }
+    util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            std::sort(bonds.begin() + segments[i], bonds.begin() + segments[i + 1], compareNeighborBond);
+        }
+    });
+
+    setBonds(bonds, m_num_query_points, m_num_points);
 }
 
 void NeighborList::validate(unsigned int num_query_points, unsigned int num_points) const
@@ -187,19 +366,6 @@ void NeighborList::validate(unsigned int num_query_points, unsigned int num_poin
         throw std::runtime_error("NeighborList found inconsistent array sizes.");
 }
 
-unsigned int NeighborList::bisection_search(unsigned int val, unsigned int left, unsigned int right) const
-{
-    if (left + 1 >= right)
-        return left;
-
-    unsigned int middle((left + right) / 2);
-
-    if (m_neighbors(middle, 0) < val)
-        return bisection_search(val, middle, right);
-    else
-        return bisection_search(val, left, middle);
-}
-
 bool compareNeighborBond(const NeighborBond& left, const NeighborBond& right)
 {
     return left.less_as_tuple(right);
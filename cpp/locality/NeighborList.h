@@ -21,8 +21,14 @@ namespace freud { namespace locality {
 
     <b>Data structures:</b>
 
-    Query point and point indices are stored in a 2D array m_neighbors of shape
-    (n_bonds, 2). The distances and weights arrays are flat per-bond arrays.
+    Bonds are sorted by query point index and stored in compressed sparse row
+    (CSR) form: the segments array of length num_query_points + 1 holds the
+    index of the first bond of each query point followed by the number of
+    bonds, so the bonds of query point i are those in [segments[i],
+    segments[i + 1]). The point indices, distances and weights arrays are flat
+    per-bond arrays. Since the query point index of each bond is implied by
+    the segments, it is not stored; the (n_bonds, 2) array of query point and
+    point indices and the array of neighbor counts are only built on request.
  */
 class NeighborList
 {
@@ -37,6 +43,15 @@ public:
     NeighborList(unsigned int num_bonds, const unsigned int* query_point_index, unsigned int num_query_points,
                  const unsigned int* point_index, unsigned int num_points, const float* distances,
                  const float* weights);
+    //! Construct from arrays, sharing the bond arrays instead of copying them
+    /*! The arrays may wrap data owned outside of freud (see
+     *  util::ManagedArray), which the NeighborList then uses without copying
+     *  it. The NeighborList never modifies the bonds in the given arrays, but
+     *  they must not be modified elsewhere while the NeighborList uses them.
+     */
+    NeighborList(const unsigned int* query_point_index, unsigned int num_query_points,
+                 const util::ManagedArray<unsigned int>& point_indices, unsigned int num_points,
+                 const util::ManagedArray<float>& distances, const util::ManagedArray<float>& weights);
 
     //! Return the number of bonds stored in this NeighborList
     unsigned int getNumBonds() const;
@@ -46,14 +61,18 @@ public:
     unsigned int getNumPoints() const;
 
     //! Set the number of bonds, query points, and points for this NeighborList object
+    /*! The bond arrays are zeroed and all bonds belong to the last query
+     *  point; use setBonds to fill in the bonds.
+     */
     void setNumBonds(unsigned int num_bonds, unsigned int num_query_points, unsigned int num_points);
-    //! Update the arrays of neighbor counts and segments
-    void updateSegmentCounts() const;
+    //! Set the bonds from a vector of bonds sorted by query point index
+    void setBonds(const std::vector<NeighborBond>& bonds, unsigned int num_query_points,
+                  unsigned int num_points);
 
-    //! Access the neighbors array for reading and writing
-    util::ManagedArray<unsigned int>& getNeighbors()
+    //! Access the point indices array for reading
+    util::ManagedArray<unsigned int>& getPointIndices()
     {
-        return m_neighbors;
+        return m_point_indices;
     }
     //! Access the distances array for reading and writing
     util::ManagedArray<float>& getDistances()
@@ -65,23 +84,16 @@ public:
     {
         return m_weights;
     }
-    //! Access the counts array for reading
-    util::ManagedArray<unsigned int>& getCounts()
-    {
-        updateSegmentCounts();
-        return m_counts;
-    }
     //! Access the segments array for reading
     util::ManagedArray<unsigned int>& getSegments()
     {
-        updateSegmentCounts();
         return m_segments;
     }
 
-    //! Access the neighbors array for reading
-    const util::ManagedArray<unsigned int>& getNeighbors() const
+    //! Access the point indices array for reading
+    const util::ManagedArray<unsigned int>& getPointIndices() const
     {
-        return m_neighbors;
+        return m_point_indices;
     }
     //! Access the distances array for reading
     const util::ManagedArray<float>& getDistances() const
@@ -93,18 +105,23 @@ public:
     {
         return m_weights;
     }
-    //! Access the counts array for reading
-    const util::ManagedArray<unsigned int>& getCounts() const
-    {
-        updateSegmentCounts();
-        return m_counts;
-    }
     //! Access the segments array for reading
     const util::ManagedArray<unsigned int>& getSegments() const
     {
-        updateSegmentCounts();
         return m_segments;
     }
+    //! Access the neighbors array of shape (n_bonds, 2) for reading
+    const util::ManagedArray<unsigned int>& getNeighbors() const
+    {
+        updateNeighbors();
+        return m_neighbors;
+    }
+    //! Access the counts array for reading
+    const util::ManagedArray<unsigned int>& getCounts() const
+    {
+        updateCounts();
+        return m_counts;
+    }
 
     //! Remove bonds in this object based on an array of boolean values. The
     //  array must be at least as long as the number of neighbor bonds.
@@ -114,6 +131,11 @@ public:
     //  constraints. Returns the number of bonds removed.
     unsigned int filter_r(float r_max, float r_min = 0);
 
+    //! Add the reverse of every bond and sort the bonds by query point and point index.
+    //  This turns a NeighborList of unique pairs into one containing both
+    //  directions of every bond.
+    void mirror();
+
     //! Return the first bond index corresponding to point i
     unsigned int find_first_index(unsigned int i) const;
 
@@ -127,26 +149,40 @@ public:
     void validate(unsigned int num_points, unsigned int num_query_points) const;
 
 private:
-    //! Helper method for bisection search of the neighbor list, used in find_first_index
-    unsigned int bisection_search(unsigned int val, unsigned int left, unsigned int right) const;
+    //! Check that the query point indices are sorted and that all indices are in range
+    void validateBonds(unsigned int num_bonds, const unsigned int* query_point_index,
+                       const unsigned int* point_index) const;
+    //! Compute the segments from the query point index of each bond, which must be sorted
+    template<typename QueryPointIndex>
+    void computeSegments(unsigned int num_bonds, const QueryPointIndex& query_point_index);
+    //! Remove the bonds for which keep_bond(bond) is false. Returns the number of bonds removed.
+    template<typename KeepBond> unsigned int filterBonds(const KeepBond& keep_bond);
+    //! Build the neighbors array from the segments and point indices if needed
+    void updateNeighbors() const;
+    //! Build the counts array from the segments if needed
+    void updateCounts() const;
 
     //! Number of query points
     unsigned int m_num_query_points;
     //! Number of points
     unsigned int m_num_points;
-    //! Neighbor list indices array
-    util::ManagedArray<unsigned int> m_neighbors;
+    //! Index of the first bond of each query point, followed by the number of bonds
+    util::ManagedArray<unsigned int> m_segments;
+    //! Neighbor list per-bond point index array
+    util::ManagedArray<unsigned int> m_point_indices;
     //! Neighbor list per-bond distance array
     util::ManagedArray<float> m_distances;
     //! Neighbor list per-bond weight array
     util::ManagedArray<float> m_weights;
 
-    //! Track whether segments and counts are up to date
-    mutable bool m_segments_counts_updated;
+    //! Track whether the neighbors array is up to date
+    mutable bool m_neighbors_updated;
+    //! Query point and point indices of each bond, built on request
+    mutable util::ManagedArray<unsigned int> m_neighbors;
+    //! Track whether counts are up to date
+    mutable bool m_counts_updated;
     //! Neighbor counts for each query point
     mutable util::ManagedArray<unsigned int> m_counts;
-    //! Neighbor segments for each query point
-    mutable util::ManagedArray<unsigned int> m_segments;
 };
 
 bool compareNeighborBond(const NeighborBond& left, const NeighborBond& right);
@@ -14,4 +14,24 @@ const float QueryArgs::DEFAULT_R_MIN(0);
 const float QueryArgs::DEFAULT_R_GUESS(-1.0);
 const float QueryArgs::DEFAULT_SCALE(-1.0);
 const bool QueryArgs::DEFAULT_EXCLUDE_II(false);
+const bool QueryArgs::DEFAULT_UNIQUE_PAIRS(false);
+
+void NeighborQuery::queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                               QueryArgs args, std::vector<NeighborBond>& bonds) const
+{
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        std::shared_ptr<NeighborQueryPerPointIterator> it = this->querySingle(query_points[i], i, args);
+        for (NeighborBond nb = it->next(); !it->end(); nb = it->next())
+        {
+            // The per-point iterators find all pairs, so the unique pairs
+            // are selected by index.
+            if (!(args.unique_pairs && nb.point_idx < i))
+            {
+                bonds.push_back(nb);
+            }
+        }
+    }
+}
+
 }; }; // end namespace freud::locality
@@ -4,9 +4,11 @@
 #ifndef NEIGHBOR_QUERY_H
 #define NEIGHBOR_QUERY_H
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 #include <tbb/tbb.h>
+#include <vector>
 
 #include "Box.h"
 #include "NeighborBond.h"
@@ -34,7 +36,8 @@ struct QueryArgs
      */
     QueryArgs()
         : mode(DEFAULT_MODE), num_neighbors(DEFAULT_NUM_NEIGHBORS), r_max(DEFAULT_R_MAX),
-          r_min(DEFAULT_R_MIN), r_guess(DEFAULT_R_GUESS), scale(DEFAULT_SCALE), exclude_ii(DEFAULT_EXCLUDE_II)
+          r_min(DEFAULT_R_MIN), r_guess(DEFAULT_R_GUESS), scale(DEFAULT_SCALE),
+          exclude_ii(DEFAULT_EXCLUDE_II), unique_pairs(DEFAULT_UNIQUE_PAIRS)
     {}
 
     //! Enumeration for types of queries.
@@ -49,11 +52,10 @@ struct QueryArgs
     unsigned int num_neighbors; //! The number of nearest neighbors to find.
     float r_max;                //! The cutoff distance within which to find neighbors.
     float r_min;                //! The minimum distance beyond which to find neighbors.
-    float r_guess; //! The initial distance for finding neighbors, used by some algorithms to initialize a
-                   //! number of neighbors query.
-    float scale; //! The scale factor to use when performing repeated ball queries to find a specified number
-                 //! of nearest neighbors.
+    float r_guess; //! Unused, kept for backwards compatibility of nearest neighbor queries.
+    float scale;   //! Unused, kept for backwards compatibility of nearest neighbor queries.
     bool exclude_ii; //! If true, exclude self-neighbors.
+    bool unique_pairs; //! If true, find each pair of points only once. The query points must be the points.
 
     static const QueryType DEFAULT_MODE;             //!< Default mode.
     static const unsigned int DEFAULT_NUM_NEIGHBORS; //!< Default number of neighbors.
@@ -62,6 +64,7 @@ struct QueryArgs
     static const float DEFAULT_R_GUESS;              //!< Default guess query distance.
     static const float DEFAULT_SCALE;     //!< Default scaling parameter for AABB nearest neighbor queries.
     static const bool DEFAULT_EXCLUDE_II; //!< Default for whether or not to include self-neighbors.
+    static const bool DEFAULT_UNIQUE_PAIRS; //!< Default for whether or not to find each pair only once.
 };
 
 // Forward declare the iterators
@@ -83,25 +86,9 @@ public:
 
     //! Constructor
     NeighborQuery(const box::Box& box, const vec3<float>* points, unsigned int n_points)
-        : m_box(box), m_points(points), m_n_points(n_points)
+        : m_box(box), m_points(nullptr), m_n_points(0)
     {
-        // Reject systems with 0 particles
-        if (m_n_points == 0)
-        {
-            throw std::invalid_argument("Cannot create a NeighborQuery with 0 particles.");
-        }
-
-        // For 2D systems, check if any z-coordinates are outside some tolerance of z=0
-        if (m_box.is2D())
-        {
-            for (unsigned int i(0); i < n_points; i++)
-            {
-                if (std::abs(m_points[i].z) > 1e-6)
-                {
-                    throw std::invalid_argument("A point with z != 0 was provided in a 2D box.");
-                }
-            }
-        }
+        setPoints(points, n_points);
     }
 
     //! Empty Destructor
@@ -123,6 +110,7 @@ public:
     query(const vec3<float>* query_points, unsigned int n_query_points, QueryArgs query_args) const
     {
         this->validateQueryArgs(query_args);
+        this->validateQueryPoints(query_points, n_query_points, query_args);
         return std::make_shared<NeighborQueryIterator>(this, query_points, n_query_points, query_args);
     }
 
@@ -139,6 +127,28 @@ public:
     virtual std::shared_ptr<NeighborQueryPerPointIterator>
     querySingle(const vec3<float> query_point, unsigned int query_point_idx, QueryArgs args) const = 0;
 
+    //! Find the neighbors of a contiguous block of query points.
+    /*! This function is the batched counterpart of querySingle. Rather than
+     *  generating a per-point iterator for each query point, all bonds of the
+     *  query points with indices in [begin, end) are appended to the
+     *  caller-provided bonds vector, grouped by query point in increasing
+     *  order. The default implementation simply exhausts the iterators
+     *  returned by querySingle; subclasses should override it with
+     *  allocation-free loops over their data structures where possible.
+     *
+     *  If unique pairs are requested, each pair of points is reported by only
+     *  one of the two query points. Which one is up to the implementation, so
+     *  callers may only rely on the bond's query point being in [begin, end).
+     *
+     *  \param query_points The points to find neighbors for.
+     *  \param begin The index of the first query point to find neighbors for.
+     *  \param end One past the index of the last query point to find neighbors for.
+     *  \param args The query arguments that should be used to find neighbors.
+     *  \param bonds The vector to which found bonds are appended.
+     */
+    virtual void queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                            QueryArgs args, std::vector<NeighborBond>& bonds) const;
+
     //! Get the simulation box
     const box::Box& getBox() const
     {
@@ -204,6 +214,55 @@ protected:
         {
             throw std::runtime_error("Unknown mode");
         }
+        if (args.unique_pairs && args.mode != QueryArgs::ball)
+        {
+            throw std::runtime_error("Unique pairs can only be found with ball queries.");
+        }
+    }
+
+    //! Validate and set the points of the NeighborQuery.
+    /*! \param points The point positions.
+     *  \param n_points The number of points.
+     */
+    void setPoints(const vec3<float>* points, unsigned int n_points)
+    {
+        // Reject systems with 0 particles
+        if (n_points == 0)
+        {
+            throw std::invalid_argument("Cannot create a NeighborQuery with 0 particles.");
+        }
+
+        // For 2D systems, check if any z-coordinates are outside some tolerance of z=0
+        if (m_box.is2D())
+        {
+            for (unsigned int i(0); i < n_points; i++)
+            {
+                if (std::abs(points[i].z) > 1e-6)
+                {
+                    throw std::invalid_argument("A point with z != 0 was provided in a 2D box.");
+                }
+            }
+        }
+
+        m_points = points;
+        m_n_points = n_points;
+    }
+
+    //! Validate the query points for the specified arguments.
+    /*! Finding each pair of points only once is only meaningful when the
+     *  query points are identical to the points.
+     */
+    void validateQueryPoints(const vec3<float>* query_points, unsigned int n_query_points,
+                             const QueryArgs& args) const
+    {
+        if (args.unique_pairs
+            && (n_query_points != m_n_points
+                || (query_points != m_points
+                    && !std::equal(query_points, query_points + n_query_points, m_points))))
+        {
+            throw std::invalid_argument(
+                "Unique pairs can only be found when the query points are the points.");
+        }
     }
 
     //! Try to determine the query mode if one is not specified.
@@ -321,6 +380,12 @@ public:
         return m_neighbor_query->querySingle(m_query_points[i], i, m_qargs);
     }
 
+    //! Append the bonds of the query points with indices in [begin, end) to bonds.
+    void queryBatch(unsigned int begin, unsigned int end, std::vector<NeighborBond>& bonds) const
+    {
+        m_neighbor_query->queryBatch(m_query_points, begin, end, m_qargs, bonds);
+    }
+
     //! Get the next element.
     NeighborBond next()
     {
@@ -333,7 +398,10 @@ public:
             {
                 nb = m_iter->next();
 
-                if (nb != ITERATOR_TERMINATOR)
+                // The per-point iterators find all pairs, so the unique
+                // pairs are selected by index.
+                if (nb != ITERATOR_TERMINATOR
+                    && !(m_qargs.unique_pairs && nb.point_idx < nb.query_point_idx))
                 {
                     return nb;
                 }
@@ -366,20 +434,7 @@ public:
         BondVector bonds;
         util::forLoopWrapper(0, m_num_query_points, [&](size_t begin, size_t end) {
             BondVector::reference local_bonds(bonds.local());
-            NeighborBond nb;
-            for (size_t i = begin; i < end; ++i)
-            {
-                std::shared_ptr<NeighborQueryPerPointIterator> it = this->query(i);
-                while (!it->end())
-                {
-                    nb = it->next();
-                    // If we're excluding ii bonds, we have to check before adding.
-                    if (nb != ITERATOR_TERMINATOR)
-                    {
-                        local_bonds.emplace_back(nb.query_point_idx, nb.point_idx, nb.distance);
-                    }
-                }
-            }
+            this->queryBatch(begin, end, local_bonds);
         });
 
         tbb::flattened2d<BondVector> flat_bonds = tbb::flatten2d(bonds);
@@ -389,20 +444,8 @@ public:
         else
             tbb::parallel_sort(linear_bonds.begin(), linear_bonds.end(), compareNeighborBond);
 
-        unsigned int num_bonds = linear_bonds.size();
-
         NeighborList* nl = new NeighborList();
-        nl->setNumBonds(num_bonds, m_num_query_points, m_neighbor_query->getNPoints());
-
-        util::forLoopWrapper(0, num_bonds, [&](size_t begin, size_t end) {
-            for (size_t bond = begin; bond < end; ++bond)
-            {
-                nl->getNeighbors()(bond, 0) = linear_bonds[bond].query_point_idx;
-                nl->getNeighbors()(bond, 1) = linear_bonds[bond].point_idx;
-                nl->getDistances()[bond] = linear_bonds[bond].distance;
-                nl->getWeights()[bond] = float(1.0);
-            }
-        });
+        nl->setBonds(linear_bonds, m_num_query_points, m_neighbor_query->getNPoints());
 
         return nl;
     }
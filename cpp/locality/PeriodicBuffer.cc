@@ -1,9 +1,11 @@
 // Copyright (c) 2010-2019 The Regents of the University of Michigan
 // This file is from the freud project, released under the BSD 3-Clause License.
 
+#include <numeric>
 #include <stdexcept>
 
 #include "PeriodicBuffer.h"
+#include "utils.h"
 
 /*! \file PeriodicBuffer.cc
     \brief Replicates points across periodic boundaries.
@@ -11,6 +13,11 @@
 
 namespace freud { namespace locality {
 
+namespace {
+//! Padding of the fractional coordinate bounds used to preselect the images of a point.
+const float IMAGE_SELECTION_TOLERANCE = 1e-4;
+}; // namespace
+
 void PeriodicBuffer::compute(const freud::locality::NeighborQuery* neighbor_query, const vec3<float> buff,
                              const bool use_images)
 {
@@ -51,17 +58,54 @@ void PeriodicBuffer::compute(const freud::locality::NeighborQuery* neighbor_quer
         images.z = 0;
     }
 
-    m_buffer_points.clear();
-    m_buffer_ids.clear();
+    const unsigned int n_points = neighbor_query->getNPoints();
+    const vec3<float> buffer_L(m_buffer_box.getL());
 
-    // for each point
-    for (unsigned int point_id = 0; point_id < neighbor_query->getNPoints(); point_id++)
-    {
-        for (int i = use_images ? 0 : -images.x; i <= images.x; i++)
+    // The buffer box has the same tilt factors as the box, so shifting a
+    // point by a lattice vector of the box only shifts the corresponding
+    // fractional coordinate of the point in the buffer box, by the ratio of
+    // the box lengths. This lets us preselect the images of each point that
+    // can be inside the buffer box from the fractional coordinates of the
+    // point itself. The bounds are padded so that only images far outside of
+    // the buffer box are skipped; all others are checked exactly below.
+    const vec3<float> frac_shift(L.x / buffer_L.x, L.y / buffer_L.y, is2D ? 0 : L.z / buffer_L.z);
+    auto image_range = [](float frac, float shift, int max_image, int& first, int& last) {
+        first = -max_image;
+        while (first < max_image && frac + float(first) * shift < -IMAGE_SELECTION_TOLERANCE)
+        {
+            ++first;
+        }
+        last = max_image;
+        while (last > first && frac + float(last) * shift >= 1 + IMAGE_SELECTION_TOLERANCE)
+        {
+            --last;
+        }
+    };
+
+    // Find the images of a point that belong in the buffer, writing them to
+    // the given arrays if they are not NULL. Returns the number of images.
+    auto find_images
+        = [&](unsigned int point_id, vec3<float>* buffer_points, unsigned int* buffer_ids) -> unsigned int {
+        const vec3<float> point = (*neighbor_query)[point_id];
+        vec3<int> first_image(0, 0, 0);
+        vec3<int> last_image(images);
+        if (!use_images)
+        {
+            const vec3<float> point_frac = m_buffer_box.makeFractional(point);
+            image_range(point_frac.x, frac_shift.x, images.x, first_image.x, last_image.x);
+            image_range(point_frac.y, frac_shift.y, images.y, first_image.y, last_image.y);
+            if (!is2D)
+            {
+                image_range(point_frac.z, frac_shift.z, images.z, first_image.z, last_image.z);
+            }
+        }
+
+        unsigned int num_images(0);
+        for (int i = first_image.x; i <= last_image.x; i++)
         {
-            for (int j = use_images ? 0 : -images.y; j <= images.y; j++)
+            for (int j = first_image.y; j <= last_image.y; j++)
             {
-                for (int k = use_images ? 0 : -images.z; k <= images.z; k++)
+                for (int k = first_image.z; k <= last_image.z; k++)
                 {
                     // Skip the origin image
                     if (i == 0 && j == 0 && k == 0)
@@ -71,7 +115,7 @@ void PeriodicBuffer::compute(const freud::locality::NeighborQuery* neighbor_quer
 
                     // Compute the new position for the buffer point,
                     // shifted by images.
-                    vec3<float> point_image = (*neighbor_query)[point_id];
+                    vec3<float> point_image = point;
                     point_image += float(i) * m_box.getLatticeVector(0);
                     point_image += float(j) * m_box.getLatticeVector(1);
                     if (!is2D)
@@ -87,8 +131,7 @@ void PeriodicBuffer::compute(const freud::locality::NeighborQuery* neighbor_quer
                         // have the correct number of points instead of
                         // relying on the floating point precision of the
                         // fractional check below.
-                        m_buffer_points.push_back(m_buffer_box.wrap(point_image));
-                        m_buffer_ids.push_back(point_id);
+                        point_image = m_buffer_box.wrap(point_image);
                     }
                     else
                     {
@@ -97,17 +140,46 @@ void PeriodicBuffer::compute(const freud::locality::NeighborQuery* neighbor_quer
                         // inside the buffer box. Unexpected results may occur
                         // due to numerical imprecision in this check!
                         vec3<float> buff_frac = m_buffer_box.makeFractional(point_image);
-                        if (0 <= buff_frac.x && buff_frac.x < 1 && 0 <= buff_frac.y && buff_frac.y < 1
-                            && (is2D || (0 <= buff_frac.z && buff_frac.z < 1)))
+                        if (!(0 <= buff_frac.x && buff_frac.x < 1 && 0 <= buff_frac.y && buff_frac.y < 1
+                              && (is2D || (0 <= buff_frac.z && buff_frac.z < 1))))
                         {
-                            m_buffer_points.push_back(point_image);
-                            m_buffer_ids.push_back(point_id);
+                            continue;
                         }
                     }
+
+                    if (buffer_points != NULL)
+                    {
+                        buffer_points[num_images] = point_image;
+                        buffer_ids[num_images] = point_id;
+                    }
+                    ++num_images;
                 }
             }
         }
-    }
+        return num_images;
+    };
+
+    // Count the images of each point in parallel, then fill in the images at
+    // the offsets given by a prefix sum of the counts, which keeps the images
+    // ordered by point.
+    std::vector<unsigned int> offsets(n_points + 1, 0);
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t point_id = begin; point_id < end; ++point_id)
+        {
+            offsets[point_id + 1] = find_images(point_id, NULL, NULL);
+        }
+    });
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    m_buffer_points.resize(offsets[n_points]);
+    m_buffer_ids.resize(offsets[n_points]);
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t point_id = begin; point_id < end; ++point_id)
+        {
+            find_images(point_id, m_buffer_points.data() + offsets[point_id],
+                        m_buffer_ids.data() + offsets[point_id]);
+        }
+    });
 }
 
 }; }; // end namespace freud::locality
@@ -53,6 +53,7 @@ public:
         }
 
         this->validateQueryArgs(query_args);
+        this->validateQueryPoints(query_points, n_query_points, query_args);
         return std::make_shared<NeighborQueryIterator>(this, query_points, n_query_points, query_args);
     }
 
@@ -69,6 +70,19 @@ public:
         return aq->querySingle(query_point, query_point_idx, qargs);
     }
 
+    //! Forward batched queries to the underlying AABBQuery object.
+    virtual void queryBatch(const vec3<float>* query_points, unsigned int begin, unsigned int end,
+                            QueryArgs qargs, std::vector<NeighborBond>& bonds) const
+    {
+        if (!aq)
+        {
+            throw std::runtime_error("The underlying AABBQuery object has not yet been initialized. Please "
+                                     "report this error.");
+        }
+
+        aq->queryBatch(query_points, begin, end, qargs, bonds);
+    }
+
 private:
     mutable std::unique_ptr<AABBQuery> aq; //!< The AABBQuery object that will be used to perform queries.
 };
@@ -0,0 +1,137 @@
+// Copyright (c) 2010-2019 The Regents of the University of Michigan
+// This file is from the freud project, released under the BSD 3-Clause License.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <tbb/tbb.h>
+
+#include "VerletList.h"
+#include "utils.h"
+
+/*! \file VerletList.cc
+    \brief Reuses neighbor lists across frames using a skin distance.
+*/
+
+namespace freud { namespace locality {
+
+namespace {
+//! Compute the largest distance between corresponding points of two sets.
+float maxDisplacement(const box::Box& box, const std::vector<vec3<float>>& old_points,
+                      const vec3<float>* points)
+{
+    tbb::enumerable_thread_specific<float> local_max_sq(0);
+    util::forLoopWrapper(0, old_points.size(), [&](size_t begin, size_t end) {
+        float& max_sq = local_max_sq.local();
+        for (size_t i = begin; i < end; ++i)
+        {
+            const vec3<float> delta(box.wrap(points[i] - old_points[i]));
+            max_sq = std::max(max_sq, dot(delta, delta));
+        }
+    });
+    return std::sqrt(local_max_sq.combine([](float a, float b) { return std::max(a, b); }));
+}
+}; // namespace
+
+VerletList::VerletList(float skin)
+    : m_skin(skin), m_valid(false), m_num_builds(0), m_same_points(false),
+      m_neighbor_list(std::make_shared<NeighborList>())
+{
+    if (skin < 0)
+    {
+        throw std::invalid_argument("VerletList requires the skin to be non-negative.");
+    }
+}
+
+void VerletList::reset()
+{
+    m_valid = false;
+}
+
+void VerletList::compute(const NeighborQuery* nq, const vec3<float>* query_points,
+                         unsigned int n_query_points, QueryArgs qargs)
+{
+    if (qargs.mode == QueryArgs::nearest || qargs.num_neighbors != QueryArgs::DEFAULT_NUM_NEIGHBORS)
+    {
+        throw std::invalid_argument("VerletList only supports ball queries.");
+    }
+    if (qargs.r_max == QueryArgs::DEFAULT_R_MAX)
+    {
+        throw std::invalid_argument("You must set r_max in the query arguments of a VerletList.");
+    }
+    qargs.mode = QueryArgs::ball;
+
+    if (!canReuse(nq, query_points, n_query_points, qargs))
+    {
+        build(nq, query_points, n_query_points, qargs);
+    }
+
+    // Recompute the distances of the stored bonds with the current positions
+    // and keep those within range.
+    const box::Box& box = nq->getBox();
+    const vec3<float>* points = nq->getPoints();
+    m_neighbor_list->copy(*m_buffer_list);
+    const unsigned int num_bonds = m_neighbor_list->getNumBonds();
+    std::unique_ptr<bool[]> in_range(new bool[num_bonds]);
+    const util::ManagedArray<unsigned int>& segments = m_neighbor_list->getSegments();
+    const util::ManagedArray<unsigned int>& point_indices = m_neighbor_list->getPointIndices();
+    util::ManagedArray<float>& distances = m_neighbor_list->getDistances();
+    util::forLoopWrapper(0, n_query_points, [&](size_t begin, size_t end) {
+        for (size_t query_point_idx = begin; query_point_idx < end; ++query_point_idx)
+        {
+            for (unsigned int bond = segments[query_point_idx]; bond < segments[query_point_idx + 1]; ++bond)
+            {
+                const vec3<float> r_ij(box.wrap(points[point_indices[bond]] - query_points[query_point_idx]));
+                const float distance = std::sqrt(dot(r_ij, r_ij));
+                distances[bond] = distance;
+                in_range[bond] = (distance < qargs.r_max && distance >= qargs.r_min);
+            }
+        }
+    });
+    m_neighbor_list->filter(in_range.get());
+}
+
+bool VerletList::canReuse(const NeighborQuery* nq, const vec3<float>* query_points,
+                          unsigned int n_query_points, const QueryArgs& qargs) const
+{
+    if (!m_valid || nq->getBox() != m_box || nq->getNPoints() != m_build_points.size()
+        || n_query_points != m_build_query_points.size() || qargs.r_max != m_qargs.r_max
+        || qargs.r_min != m_qargs.r_min || qargs.exclude_ii != m_qargs.exclude_ii
+        || qargs.unique_pairs != m_qargs.unique_pairs)
+    {
+        return false;
+    }
+
+    // A bond can only have come within r_max if the two points together moved
+    // by more than the skin since the bonds were found.
+    const float point_displacement = maxDisplacement(m_box, m_build_points, nq->getPoints());
+    const bool same_points = (query_points == nq->getPoints());
+    if (same_points != m_same_points)
+    {
+        return false;
+    }
+    const float query_point_displacement = same_points
+        ? point_displacement
+        : maxDisplacement(m_box, m_build_query_points, query_points);
+    return point_displacement + query_point_displacement < m_skin;
+}
+
+void VerletList::build(const NeighborQuery* nq, const vec3<float>* query_points, unsigned int n_query_points,
+                       const QueryArgs& qargs)
+{
+    QueryArgs buffer_args(qargs);
+    buffer_args.r_max = qargs.r_max + m_skin;
+    buffer_args.r_min = std::max(qargs.r_min - m_skin, float(0));
+    m_buffer_list.reset(nq->query(query_points, n_query_points, buffer_args)->toNeighborList());
+
+    m_box = nq->getBox();
+    m_qargs = qargs;
+    m_same_points = (query_points == nq->getPoints());
+    m_build_points.assign(nq->getPoints(), nq->getPoints() + nq->getNPoints());
+    m_build_query_points.assign(query_points, query_points + n_query_points);
+    m_valid = true;
+    ++m_num_builds;
+}
+
+}; }; // end namespace freud::locality
@@ -0,0 +1,97 @@
+// Copyright (c) 2010-2019 The Regents of the University of Michigan
+// This file is from the freud project, released under the BSD 3-Clause License.
+
+#ifndef VERLET_LIST_H
+#define VERLET_LIST_H
+
+#include <memory>
+#include <vector>
+
+#include "Box.h"
+#include "NeighborList.h"
+#include "NeighborQuery.h"
+#include "VectorMath.h"
+
+/*! \file VerletList.h
+    \brief Reuses neighbor lists across frames using a skin distance.
+*/
+
+namespace freud { namespace locality {
+
+//! Neighbor list that is only rebuilt when points have moved far enough.
+/*! In trajectory analysis, points usually move very little between
+ *  consecutive frames. This class finds all bonds within r_max + skin and
+ *  stores them together with the positions of the points at the time they were
+ *  found. On subsequent computes, the stored bonds are reused as long as the
+ *  largest displacement of the points plus the largest displacement of the
+ *  query points is smaller than the skin, since no pair of points can then
+ *  have moved within r_max of each other without already being a stored bond.
+ *  The neighbor list is obtained by recomputing the distances of the stored
+ *  bonds and removing those outside of [r_min, r_max).
+ *
+ *  The stored bonds are also discarded when the box, the number of points or
+ *  the query arguments change. Only ball queries are supported.
+ */
+class VerletList
+{
+public:
+    //! Constructor
+    /*! \param skin The distance beyond r_max within which bonds are stored.
+     */
+    VerletList(float skin);
+
+    //! Compute the neighbor list, reusing the stored bonds if possible.
+    /*! \param nq NeighborQuery object containing the points.
+     *  \param query_points The points to find neighbors for.
+     *  \param n_query_points The number of query points.
+     *  \param qargs The arguments of the ball query.
+     */
+    void compute(const NeighborQuery* nq, const vec3<float>* query_points, unsigned int n_query_points,
+                 QueryArgs qargs);
+
+    //! Discard the stored bonds so that the next compute finds them again.
+    void reset();
+
+    //! Get the skin distance
+    float getSkin() const
+    {
+        return m_skin;
+    }
+
+    //! Get the number of times the stored bonds have been found with a NeighborQuery
+    unsigned int getNumBuilds() const
+    {
+        return m_num_builds;
+    }
+
+    //! Get the neighbor list of the last compute
+    std::shared_ptr<NeighborList> getNeighborList() const
+    {
+        return m_neighbor_list;
+    }
+
+private:
+    //! Check whether the stored bonds are valid for the given input.
+    bool canReuse(const NeighborQuery* nq, const vec3<float>* query_points, unsigned int n_query_points,
+                  const QueryArgs& qargs) const;
+
+    //! Find and store all bonds within r_max + skin.
+    void build(const NeighborQuery* nq, const vec3<float>* query_points, unsigned int n_query_points,
+               const QueryArgs& qargs);
+
+    float m_skin;              //!< Distance beyond r_max within which bonds are stored.
+    bool m_valid;              //!< Whether bonds have been stored since the last reset.
+    unsigned int m_num_builds; //!< Number of times the stored bonds have been found.
+
+    box::Box m_box;     //!< Box of the stored bonds.
+    QueryArgs m_qargs;  //!< Query arguments of the stored bonds.
+    bool m_same_points; //!< Whether the query points were the points when the bonds were stored.
+    std::vector<vec3<float>> m_build_points;       //!< Positions of the points when bonds were stored.
+    std::vector<vec3<float>> m_build_query_points; //!< Positions of the query points when bonds were stored.
+    std::unique_ptr<NeighborList> m_buffer_list;   //!< Stored bonds within r_max + skin.
+    std::shared_ptr<NeighborList> m_neighbor_list; //!< Neighbor list of the last compute.
+};
+
+}; }; // end namespace freud::locality
+
+#endif // VERLET_LIST_H
@@ -1,12 +1,17 @@
 // Copyright (c) 2010-2019 The Regents of the University of Michigan
 // This file is from the freud project, released under the BSD 3-Clause License.
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <numeric>
 #include <tbb/tbb.h>
+#include <utility>
 #include <vector>
 
 #include "NeighborBond.h"
 #include "Voronoi.h"
+#include "utils.h"
 
 /*! \file Voronoi.cc
     \brief Computes Voronoi neighbors for a set of points.
@@ -14,26 +19,248 @@
 
 namespace freud { namespace locality {
 
-// Voronoi calculations should be kept in double precision.
-void Voronoi::compute(const freud::locality::NeighborQuery* nq)
+namespace {
+
+//! Average number of points per bin of the grid used to find the neighbors of 2D cells.
+const double POINTS_PER_BIN_2D = 3.0;
+
+//! Tolerance, relative to the squared distance to a neighbor, for a vertex to lie on its bisector.
+const double CUT_TOLERANCE_2D = 1e-10;
+
+//! Cells computed by one thread, kept until the cells of all threads are gathered.
+struct VoronoiCells
 {
-    auto box = nq->getBox();
-    auto n_points = nq->getNPoints();
+    std::vector<NeighborBond> bonds;                     //!< Bonds of the computed cells.
+    std::vector<unsigned int> points;                    //!< Points whose polytopes were saved.
+    std::vector<unsigned int> vertex_offsets {0};        //!< First vertex of each saved polytope.
+    std::vector<vec3<double>> polytope_vertices;         //!< Vertices of the saved polytopes.
+};
 
-    m_polytopes.resize(n_points);
-    m_volumes.prepare(n_points);
+//! Per-thread state for computing 3D Voronoi cells.
+/*! voro++ containers create the periodic images of their blocks while
+ *  computing cells, so a container cannot be shared between threads. Each
+ *  thread builds its own container of all points.
+ */
+struct VoronoiWorker : public VoronoiCells
+{
+    std::unique_ptr<voro::container_periodic> container; //!< Container of all points.
+    std::vector<std::pair<int, int>> locations; //!< Block and index in the block of each point.
+    voro::voronoicell_neighbor cell;            //!< The cell being computed.
+    std::vector<double> face_areas;             //!< Face areas of the cell being computed.
+    std::vector<int> neighbors;                 //!< Neighbors of the cell being computed.
+    std::vector<double> vertices;               //!< Relative vertices of the cell being computed.
+};
 
-    vec3<float> boxLatticeVectors[3];
-    boxLatticeVectors[0] = box.getLatticeVector(0);
-    boxLatticeVectors[1] = box.getLatticeVector(1);
-    if (box.is2D())
+//! Per-thread state for computing 2D Voronoi cells.
+/*! A 2D cell is a convex polygon, stored relative to its point with its
+ *  vertices in counterclockwise order, that is cut down by the perpendicular
+ *  bisectors of the point and its neighbors.
+ */
+struct Voronoi2DWorker : public VoronoiCells
+{
+    std::vector<vec2<double>> vertices;          //!< Vertices of the cell being computed.
+    std::vector<int> edge_neighbors;             //!< Neighbor across the edge starting at each vertex.
+    std::vector<vec2<double>> cut_vertices;      //!< Vertices of the cell after a cut.
+    std::vector<int> cut_edge_neighbors;         //!< Edge neighbors of the cell after a cut.
+};
+
+//! Save the vertices of the 3D cell of a point in system coordinates.
+void savePolytope(VoronoiWorker& worker, unsigned int query_point_id,
+                  const vec3<double>& query_point_system_coords)
+{
+    worker.cell.vertices(worker.vertices);
+    for (size_t i = 0; i < worker.vertices.size(); i += 3)
+    {
+        const vec3<double> delta(worker.vertices[i], worker.vertices[i + 1], worker.vertices[i + 2]);
+        worker.polytope_vertices.push_back(delta + query_point_system_coords);
+    }
+    worker.points.push_back(query_point_id);
+    worker.vertex_offsets.push_back(worker.polytope_vertices.size());
+}
+
+//! Save the vertices of the 2D cell of a point in system coordinates.
+/*! The vertices start from the one with the smallest polar angle relative to
+ *  the point and are in counterclockwise order.
+ */
+void savePolygon(Voronoi2DWorker& worker, unsigned int query_point_id,
+                 const vec3<double>& query_point_system_coords)
+{
+    const std::vector<vec2<double>>& vertices = worker.vertices;
+    const size_t first = std::min_element(vertices.begin(), vertices.end(),
+                                          [](const vec2<double>& a, const vec2<double>& b) {
+                                              return std::atan2(a.y, a.x) < std::atan2(b.y, b.x);
+                                          })
+        - vertices.begin();
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const vec2<double>& vertex = vertices[(first + i) % vertices.size()];
+        worker.polytope_vertices.push_back(vec3<double>(vertex.x, vertex.y, 0) + query_point_system_coords);
+    }
+    worker.points.push_back(query_point_id);
+    worker.vertex_offsets.push_back(worker.polytope_vertices.size());
+}
+
+//! Cut a 2D cell with the perpendicular bisector of its point and a neighbor.
+/*! \param worker The worker holding the cell.
+ *  \param delta Vector from the point to the neighbor.
+ *  \param neighbor Index of the neighbor.
+ *  \returns Whether any part of the cell was cut off.
+ */
+bool cutCell2D(Voronoi2DWorker& worker, const vec2<double>& delta, int neighbor)
+{
+    // A vertex v is beyond the bisector if dot(v, delta) > |delta|^2 / 2.
+    const double half_rsq = 0.5 * dot(delta, delta);
+    const double tolerance = CUT_TOLERANCE_2D * half_rsq;
+    const std::vector<vec2<double>>& vertices = worker.vertices;
+    const size_t n_vertices = vertices.size();
+
+    bool any_outside = false;
+    for (size_t i = 0; i < n_vertices; ++i)
+    {
+        if (dot(vertices[i], delta) - half_rsq > tolerance)
+        {
+            any_outside = true;
+            break;
+        }
+    }
+    if (!any_outside)
+    {
+        return false;
+    }
+
+    // Vertices within the tolerance of the bisector are kept and become an
+    // end of the new edge, so that no edges of vanishing length are created.
+    worker.cut_vertices.clear();
+    worker.cut_edge_neighbors.clear();
+    for (size_t i = 0; i < n_vertices; ++i)
     {
-        boxLatticeVectors[2] = vec3<float>(0, 0, 1);
+        const vec2<double>& a = vertices[i];
+        const vec2<double>& b = vertices[(i + 1) % n_vertices];
+        const double side_a = dot(a, delta) - half_rsq;
+        const double side_b = dot(b, delta) - half_rsq;
+        const bool a_outside = side_a > tolerance;
+        const bool b_outside = side_b > tolerance;
+
+        if (!a_outside)
+        {
+            // A vertex on the bisector followed by one beyond it starts the
+            // new edge.
+            worker.cut_vertices.push_back(a);
+            worker.cut_edge_neighbors.push_back(
+                (b_outside && side_a >= -tolerance) ? neighbor : worker.edge_neighbors[i]);
+        }
+        if ((side_a < -tolerance && b_outside) || (a_outside && side_b < -tolerance))
+        {
+            // The edge crosses the bisector. Leaving the cell starts the new
+            // edge, entering it again starts the rest of the cut edge.
+            worker.cut_vertices.push_back(a + (b - a) * (side_a / (side_a - side_b)));
+            worker.cut_edge_neighbors.push_back(a_outside ? worker.edge_neighbors[i] : neighbor);
+        }
+    }
+    std::swap(worker.vertices, worker.cut_vertices);
+    std::swap(worker.edge_neighbors, worker.cut_edge_neighbors);
+    return true;
+}
+
+//! Largest squared distance of a vertex of a 2D cell from its point.
+double maxVertexRsq(const std::vector<vec2<double>>& vertices)
+{
+    double max_rsq(0);
+    for (auto vertex = vertices.begin(); vertex != vertices.end(); ++vertex)
+    {
+        max_rsq = std::max(max_rsq, dot(*vertex, *vertex));
+    }
+    return max_rsq;
+}
+
+}; // namespace
+
+template<typename Workers> void Voronoi::gatherCells(Workers& workers, unsigned int n_points)
+{
+    // Gather the bonds of all threads.
+    size_t num_bonds(0);
+    for (auto worker = workers.begin(); worker != workers.end(); ++worker)
+    {
+        num_bonds += worker->bonds.size();
+    }
+    std::vector<NeighborBond> bonds;
+    bonds.reserve(num_bonds);
+    for (auto worker = workers.begin(); worker != workers.end(); ++worker)
+    {
+        bonds.insert(bonds.end(), worker->bonds.begin(), worker->bonds.end());
+    }
+
+    tbb::parallel_sort(bonds.begin(), bonds.end(), [](const NeighborBond& n1, const NeighborBond& n2) {
+        return n1.less_id_ref_weight(n2);
+    });
+
+    m_neighbor_list->setBonds(bonds, n_points, n_points);
+
+    if (m_neighbors_only)
+    {
+        m_polytope_segments.prepare(0);
+        m_polytope_vertices.prepare({0, 3});
+        return;
+    }
+
+    // The prefix sum of the number of vertices of each polytope gives the
+    // first vertex of each polytope.
+    m_polytope_segments.prepare(n_points + 1);
+    unsigned int* segments = m_polytope_segments.get();
+    for (auto worker = workers.begin(); worker != workers.end(); ++worker)
+    {
+        for (size_t i = 0; i < worker->points.size(); ++i)
+        {
+            segments[worker->points[i] + 1] = worker->vertex_offsets[i + 1] - worker->vertex_offsets[i];
+        }
+    }
+    std::partial_sum(segments, segments + n_points + 1, segments);
+
+    // Copy the polytope vertices of all threads into a single array.
+    m_polytope_vertices.prepare({segments[n_points], 3});
+    double* polytope_vertices = m_polytope_vertices.get();
+    for (auto worker = workers.begin(); worker != workers.end(); ++worker)
+    {
+        const VoronoiCells& source = *worker;
+        util::forLoopWrapper(0, source.points.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                double* destination = polytope_vertices + 3 * segments[source.points[i]];
+                for (unsigned int vertex = source.vertex_offsets[i]; vertex < source.vertex_offsets[i + 1];
+                     ++vertex)
+                {
+                    *(destination++) = source.polytope_vertices[vertex].x;
+                    *(destination++) = source.polytope_vertices[vertex].y;
+                    *(destination++) = source.polytope_vertices[vertex].z;
+                }
+            }
+        });
+    }
+}
+
+void Voronoi::compute(const freud::locality::NeighborQuery* nq)
+{
+    m_volumes.prepare(nq->getNPoints());
+    if (nq->getBox().is2D())
+    {
+        compute2D(nq);
     }
     else
     {
-        boxLatticeVectors[2] = box.getLatticeVector(2);
+        compute3D(nq);
     }
+}
+
+// Voronoi calculations should be kept in double precision.
+void Voronoi::compute3D(const freud::locality::NeighborQuery* nq)
+{
+    auto box = nq->getBox();
+    auto n_points = nq->getNPoints();
+
+    vec3<float> boxLatticeVectors[3];
+    boxLatticeVectors[0] = box.getLatticeVector(0);
+    boxLatticeVectors[1] = box.getLatticeVector(1);
+    boxLatticeVectors[2] = box.getLatticeVector(2);
 
     // This heuristic for choosing blocks is based on the voro::pre_container
     // guess_optimal method. By computing the heuristic directly, we avoid
@@ -45,140 +272,247 @@ void Voronoi::compute(const freud::locality::NeighborQuery* nq)
     int voro_blocks_y = int(box.getLy() * block_scale + 1);
     int voro_blocks_z = int(box.getLz() * block_scale + 1);
 
-    voro::container_periodic container(boxLatticeVectors[0].x, boxLatticeVectors[1].x, boxLatticeVectors[1].y,
-                                       boxLatticeVectors[2].x, boxLatticeVectors[2].y, boxLatticeVectors[2].z,
-                                       voro_blocks_x, voro_blocks_y, voro_blocks_z, 3);
-
-    for (size_t query_point_id = 0; query_point_id < n_points; query_point_id++)
-    {
-        vec3<double> query_point((*nq)[query_point_id]);
-        container.put(query_point_id, query_point.x, query_point.y, query_point.z);
-    }
+    // Build a container of all points and find the block of each point, so
+    // that the cells of arbitrary points can be computed from it.
+    auto build_container = [&](VoronoiWorker& worker) {
+        worker.container.reset(new voro::container_periodic(
+            boxLatticeVectors[0].x, boxLatticeVectors[1].x, boxLatticeVectors[1].y, boxLatticeVectors[2].x,
+            boxLatticeVectors[2].y, boxLatticeVectors[2].z, voro_blocks_x, voro_blocks_y, voro_blocks_z, 3));
+        for (size_t point_id = 0; point_id < n_points; point_id++)
+        {
+            vec3<double> point((*nq)[point_id]);
+            worker.container->put(point_id, point.x, point.y, point.z);
+        }
 
-    voro::voronoicell_neighbor cell;
-    voro::c_loop_all_periodic voronoi_loop(container);
-    std::vector<double> face_areas;
-    std::vector<int> face_vertices;
-    std::vector<int> neighbors;
-    std::vector<double> normals;
-    std::vector<double> vertices;
-    std::vector<NeighborBond> bonds;
+        worker.locations.resize(n_points);
+        voro::c_loop_all_periodic voronoi_loop(*worker.container);
+        if (voronoi_loop.start())
+        {
+            do
+            {
+                worker.locations[voronoi_loop.pid()] = std::make_pair(voronoi_loop.ijk, voronoi_loop.q);
+            } while (voronoi_loop.inc());
+        }
+    };
 
-    if (voronoi_loop.start())
-    {
-        do
+    tbb::enumerable_thread_specific<VoronoiWorker> workers;
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        VoronoiWorker& worker = workers.local();
+        if (!worker.container)
         {
-            container.compute_cell(cell, voronoi_loop);
+            build_container(worker);
+        }
 
-            // Get id and position of current particle
-            const int query_point_id(voronoi_loop.pid());
-            vec3<double> query_point(voronoi_loop.x(), voronoi_loop.y(), voronoi_loop.z());
+        for (size_t query_point_id = begin; query_point_id < end; query_point_id++)
+        {
+            voro::voronoicell_neighbor& cell = worker.cell;
+            worker.container->compute_cell(cell, worker.locations[query_point_id].first,
+                                           worker.locations[query_point_id].second);
 
             // Get Voronoi cell properties
-            cell.face_areas(face_areas);
-            cell.face_vertices(face_vertices);
-            cell.neighbors(neighbors);
-            cell.normals(normals);
-            cell.vertices(query_point.x, query_point.y, query_point.z, vertices);
-
-            // Compute polytope vertices in relative coordinates
-            std::vector<vec3<double>> relative_vertices;
-            auto vertex_iterator = vertices.begin();
-            while (vertex_iterator != vertices.end())
-            {
-                double vert_x = *vertex_iterator;
-                vertex_iterator++;
-                double vert_y = *vertex_iterator;
-                vertex_iterator++;
-                double vert_z = *vertex_iterator;
-                vertex_iterator++;
-
-                // In 2D systems, only use vertices from the upper plane
-                // to prevent double-counting, and set z=0 manually
-                if (box.is2D())
-                {
-                    if (vert_z < 0)
-                    {
-                        continue;
-                    }
-                    vert_z = 0;
-                }
-                vec3<double> delta = vec3<double>(vert_x, vert_y, vert_z) - query_point;
-                relative_vertices.push_back(delta);
-            }
+            cell.face_areas(worker.face_areas);
+            cell.neighbors(worker.neighbors);
 
-            // Sort relative vertices by their angle in 2D systems
-            if (box.is2D())
-            {
-                std::sort(relative_vertices.begin(), relative_vertices.end(),
-                          [](const vec3<double> a, const vec3<double> b) {
-                              return std::atan2(a.y, a.x) < std::atan2(b.y, b.x);
-                          });
-            }
-
-            // Save polytope vertices in system coordinates
-            std::vector<vec3<double>> system_vertices;
+            // Save polytope vertices in system coordinates. The vertices of
+            // the cell are relative to the point, which may have been
+            // wrapped into the container.
             const vec3<double> query_point_system_coords((*nq)[query_point_id]);
-            for (auto vertex_iter = relative_vertices.begin(); vertex_iter != relative_vertices.end();
-                 vertex_iter++)
+            if (!m_neighbors_only)
             {
-                system_vertices.push_back((*vertex_iter) + query_point_system_coords);
+                savePolytope(worker, query_point_id, query_point_system_coords);
             }
-            m_polytopes[query_point_id] = system_vertices;
 
             // Save cell volume
             m_volumes[query_point_id] = cell.volume();
 
             // Compute cell neighbors
-            size_t neighbor_counter(0);
-            for (auto neighbor_iterator = neighbors.begin(); neighbor_iterator != neighbors.end();
-                 neighbor_iterator++, neighbor_counter++)
+            for (size_t neighbor_counter = 0; neighbor_counter < worker.neighbors.size(); neighbor_counter++)
             {
-                // Get the normal to the current face
-                const vec3<double> normal(normals[3 * neighbor_counter], normals[3 * neighbor_counter + 1],
-                                          normals[3 * neighbor_counter + 2]);
-
-                // Ignore bonds in 2D systems that point up or down. This check
-                // should only be dealing with bonds whose normal vectors' z
-                // components are -1, 0, or +1 (within some tolerance).
-                if (box.is2D() && std::abs(normal.z) > 0.5)
-                {
-                    continue;
-                }
-
                 // Fetch neighbor information
-                const int point_id = *neighbor_iterator;
-                const float weight(face_areas[neighbor_counter]);
+                const int point_id = worker.neighbors[neighbor_counter];
+                const float weight(worker.face_areas[neighbor_counter]);
                 const vec3<double> point_system_coords((*nq)[point_id]);
 
                 // Compute the distance from query_point to point.
                 const vec3<float> rij = box.wrap(point_system_coords - query_point_system_coords);
                 const float distance(std::sqrt(dot(rij, rij)));
 
-                bonds.push_back(NeighborBond(query_point_id, point_id, distance, weight));
+                worker.bonds.push_back(NeighborBond(query_point_id, point_id, distance, weight));
             }
+        }
+    });
+
+    gatherCells(workers, n_points);
+}
+
+// The cell of each point is cut from a polygon containing it by the
+// bisectors of the points in the bins of a periodic grid, searching rings of
+// bins around the point until no point in the next ring can reach the cell.
+void Voronoi::compute2D(const freud::locality::NeighborQuery* nq)
+{
+    auto box = nq->getBox();
+    auto n_points = nq->getNPoints();
 
-        } while (voronoi_loop.inc());
+    const vec2<double> lattice_x(box.getLx(), 0);
+    const vec2<double> lattice_y(double(box.getTiltFactorXY()) * box.getLy(), box.getLy());
+    // Distances between the lines of constant fractional x and y coordinates
+    const double width_x = box.getLx() * double(box.getLy()) / std::sqrt(dot(lattice_y, lattice_y));
+    const double width_y = box.getLy();
+
+    // Choose square bins holding a few points each on average.
+    int n_bins_x(1);
+    int n_bins_y(1);
+    if (n_points > 0)
+    {
+        const double bin_width = std::sqrt(POINTS_PER_BIN_2D * box.getVolume() / n_points);
+        n_bins_x = std::max(1, int(box.getLx() / bin_width));
+        n_bins_y = std::max(1, int(box.getLy() / bin_width));
     }
 
-    tbb::parallel_sort(bonds.begin(), bonds.end(), [](const NeighborBond& n1, const NeighborBond& n2) {
-        return n1.less_id_ref_weight(n2);
+    // Find the fractional coordinates and bin of each point, and its
+    // position in the box, in double precision.
+    std::vector<vec2<double>> fractions(n_points);
+    std::vector<vec2<double>> positions(n_points);
+    std::vector<unsigned int> point_bins(n_points);
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const vec3<double> point((*nq)[i]);
+            vec2<double> fraction(
+                (point.x - double(box.getTiltFactorXY()) * point.y) / box.getLx() + 0.5,
+                point.y / box.getLy() + 0.5);
+            const vec2<double> image(std::floor(fraction.x), std::floor(fraction.y));
+            fraction = fraction - image;
+            positions[i] = vec2<double>(point.x, point.y) - lattice_x * image.x - lattice_y * image.y;
+            fractions[i] = fraction;
+            const int bin_x = std::min(int(fraction.x * n_bins_x), n_bins_x - 1);
+            const int bin_y = std::min(int(fraction.y * n_bins_y), n_bins_y - 1);
+            point_bins[i] = bin_y * n_bins_x + bin_x;
+        }
     });
 
-    unsigned int num_bonds = bonds.size();
+    // Sort the points by bin.
+    std::vector<unsigned int> bin_offsets(n_bins_x * n_bins_y + 1, 0);
+    for (size_t i = 0; i < n_points; ++i)
+    {
+        ++bin_offsets[point_bins[i] + 1];
+    }
+    std::partial_sum(bin_offsets.begin(), bin_offsets.end(), bin_offsets.begin());
+    std::vector<unsigned int> bin_points(n_points);
+    std::vector<unsigned int> bin_fill(bin_offsets.begin(), bin_offsets.end() - 1);
+    for (size_t i = 0; i < n_points; ++i)
+    {
+        bin_points[bin_fill[point_bins[i]]++] = i;
+    }
+
+    // Every point of the plane is closer than this to some periodic image of
+    // the point, so the initial polygon contains the cell.
+    const double initial_half_width
+        = std::sqrt(dot(lattice_x, lattice_x)) + std::sqrt(dot(lattice_y, lattice_y));
 
-    m_neighbor_list->resize(num_bonds);
-    m_neighbor_list->setNumBonds(num_bonds, n_points, n_points);
+    tbb::enumerable_thread_specific<Voronoi2DWorker> workers;
+    util::forLoopWrapper(0, n_points, [&](size_t begin, size_t end) {
+        Voronoi2DWorker& worker = workers.local();
 
-    util::forLoopWrapper(0, num_bonds, [=](size_t begin, size_t end) {
-        for (size_t bond = begin; bond != end; ++bond)
+        for (size_t query_point_id = begin; query_point_id < end; query_point_id++)
         {
-            m_neighbor_list->getNeighbors()(bond, 0) = bonds[bond].query_point_idx;
-            m_neighbor_list->getNeighbors()(bond, 1) = bonds[bond].point_idx;
-            m_neighbor_list->getDistances()[bond] = bonds[bond].distance;
-            m_neighbor_list->getWeights()[bond] = bonds[bond].weight;
+            const vec2<double>& query_fraction = fractions[query_point_id];
+            const vec2<double>& query_position = positions[query_point_id];
+            const int query_bin_x = point_bins[query_point_id] % n_bins_x;
+            const int query_bin_y = point_bins[query_point_id] / n_bins_x;
+
+            worker.vertices.assign({vec2<double>(-initial_half_width, -initial_half_width),
+                                    vec2<double>(initial_half_width, -initial_half_width),
+                                    vec2<double>(initial_half_width, initial_half_width),
+                                    vec2<double>(-initial_half_width, initial_half_width)});
+            worker.edge_neighbors.assign(4, -1);
+            double max_rsq = maxVertexRsq(worker.vertices);
+
+            for (int ring = 0;; ++ring)
+            {
+                for (int dy = -ring; dy <= ring; ++dy)
+                {
+                    // Only visit the bins on the boundary of the ring.
+                    const int step_x = (dy == -ring || dy == ring) ? 1 : 2 * ring;
+                    for (int dx = -ring; dx <= ring; dx += step_x)
+                    {
+                        const int bin_x = query_bin_x + dx;
+                        const int bin_y = query_bin_y + dy;
+                        const int image_x = (bin_x >= 0 ? bin_x : bin_x - n_bins_x + 1) / n_bins_x;
+                        const int image_y = (bin_y >= 0 ? bin_y : bin_y - n_bins_y + 1) / n_bins_y;
+                        const unsigned int bin = (bin_y - image_y * n_bins_y) * n_bins_x
+                            + (bin_x - image_x * n_bins_x);
+                        const vec2<double> image_shift
+                            = lattice_x * double(image_x) + lattice_y * double(image_y);
+
+                        for (unsigned int j = bin_offsets[bin]; j < bin_offsets[bin + 1]; ++j)
+                        {
+                            const unsigned int point_id = bin_points[j];
+                            const vec2<double> delta = positions[point_id] + image_shift - query_position;
+                            const double rsq = dot(delta, delta);
+
+                            // Skip the point itself and points too far away
+                            // for their bisector to reach the cell.
+                            if (rsq == 0 || rsq >= 4 * max_rsq)
+                            {
+                                continue;
+                            }
+                            if (cutCell2D(worker, delta, point_id))
+                            {
+                                max_rsq = maxVertexRsq(worker.vertices);
+                            }
+                        }
+                    }
+                }
+
+                // Distance from the point to the boundary of the searched bins
+                const double distance_x
+                    = std::min(query_fraction.x - double(query_bin_x - ring) / n_bins_x,
+                               double(query_bin_x + ring + 1) / n_bins_x - query_fraction.x)
+                    * width_x;
+                const double distance_y
+                    = std::min(query_fraction.y - double(query_bin_y - ring) / n_bins_y,
+                               double(query_bin_y + ring + 1) / n_bins_y - query_fraction.y)
+                    * width_y;
+                const double distance = std::min(distance_x, distance_y);
+                if (4 * max_rsq <= distance * distance)
+                {
+                    break;
+                }
+            }
+
+            const vec3<double> query_point_system_coords((*nq)[query_point_id]);
+            if (!m_neighbors_only)
+            {
+                savePolygon(worker, query_point_id, query_point_system_coords);
+            }
+
+            // Save cell area and neighbors, whose weights are the lengths of
+            // the edges between the cells.
+            const size_t n_vertices = worker.vertices.size();
+            double area(0);
+            for (size_t i = 0; i < n_vertices; ++i)
+            {
+                const vec2<double>& a = worker.vertices[i];
+                const vec2<double>& b = worker.vertices[(i + 1) % n_vertices];
+                area += perpdot(a, b);
+
+                const int point_id = worker.edge_neighbors[i];
+                const vec2<double> edge = b - a;
+                const float weight(std::sqrt(dot(edge, edge)));
+                const vec3<double> point_system_coords((*nq)[point_id]);
+
+                // Compute the distance from query_point to point.
+                const vec3<float> rij = box.wrap(point_system_coords - query_point_system_coords);
+                const float distance(std::sqrt(dot(rij, rij)));
+
+                worker.bonds.push_back(NeighborBond(query_point_id, point_id, distance, weight));
+            }
+            m_volumes[query_point_id] = 0.5 * area;
         }
     });
+
+    gatherCells(workers, n_points);
 }
 
 }; }; // end namespace freud::locality
@@ -16,19 +16,40 @@ namespace freud { namespace locality {
 class Voronoi
 {
 public:
-    // default constructor
-    Voronoi() : m_neighbor_list(std::make_shared<NeighborList>()) {}
+    //! Constructor
+    /*! \param neighbors_only Only compute the neighbors, face areas and
+     *         volumes of the cells, skipping the polytope vertices.
+     */
+    Voronoi(bool neighbors_only = false)
+        : m_neighbors_only(neighbors_only), m_neighbor_list(std::make_shared<NeighborList>())
+    {}
 
     void compute(const freud::locality::NeighborQuery* nq);
 
+    //! Whether only neighbors, face areas and volumes are computed
+    bool isNeighborsOnly() const
+    {
+        return m_neighbors_only;
+    }
+
     std::shared_ptr<NeighborList> getNeighborList() const
     {
         return m_neighbor_list;
     }
 
-    const std::vector<std::vector<vec3<double>>> getPolytopes() const
+    //! Get the vertices of all polytopes, as an (N_vertices, 3) array
+    /*! The vertices of the polytope of point i are those in
+     *  [segments[i], segments[i + 1]) (see getPolytopeSegments).
+     */
+    const util::ManagedArray<double>& getPolytopeVertices() const
     {
-        return m_polytopes;
+        return m_polytope_vertices;
+    }
+
+    //! Get the index of the first vertex of each polytope, followed by the number of vertices
+    const util::ManagedArray<unsigned int>& getPolytopeSegments() const
+    {
+        return m_polytope_segments;
     }
 
     const util::ManagedArray<double>& getVolumes() const
@@ -37,10 +58,21 @@ public:
     }
 
 private:
+    //! Compute the cells of a 3D system with voro++
+    void compute3D(const freud::locality::NeighborQuery* nq);
+
+    //! Compute the cells of a 2D system as polygons
+    void compute2D(const freud::locality::NeighborQuery* nq);
+
+    //! Gather the bonds and polytopes of the cells computed by each thread
+    template<typename Workers> void gatherCells(Workers& workers, unsigned int n_points);
+
     box::Box m_box;
-    std::shared_ptr<NeighborList> m_neighbor_list;      //!< Stored neighbor list
-    std::vector<std::vector<vec3<double>>> m_polytopes; //!< Voronoi polytopes
-    util::ManagedArray<double> m_volumes;               //!< Voronoi cell volumes
+    bool m_neighbors_only;                                  //!< Whether to skip the polytope vertices
+    std::shared_ptr<NeighborList> m_neighbor_list;          //!< Stored neighbor list
+    util::ManagedArray<double> m_polytope_vertices;         //!< Vertices of all Voronoi polytopes
+    util::ManagedArray<unsigned int> m_polytope_segments;   //!< First vertex of each Voronoi polytope
+    util::ManagedArray<double> m_volumes;                   //!< Voronoi cell volumes
 };
 }; }; // end namespace freud::locality
 
@@ -43,9 +43,9 @@ void SolidLiquid::compute(const freud::locality::NeighborList* nlist,
             for (unsigned int i = begin; i != end; ++i)
             {
                 unsigned int bond(m_nlist.find_first_index(i));
-                for (; bond < num_bonds && m_nlist.getNeighbors()(bond, 0) == i; ++bond)
+                for (; bond < m_nlist.find_first_index(i + 1); ++bond)
                 {
-                    const unsigned int j(m_nlist.getNeighbors()(bond, 1));
+                    const unsigned int j(m_nlist.getPointIndices()[bond]);
 
                     // Accumulate the dot product over m of qlmi and qlmj vectors
                     std::complex<float> bond_ql_ij = 0;
@@ -86,12 +86,15 @@ void SolidLiquid::compute(const freud::locality::NeighborList* nlist,
     // (particles with more than solid_threshold solid-like bonds)
     const unsigned int num_solid_bonds(solid_nlist.getNumBonds());
     std::unique_ptr<bool[]> neighbor_count_filter(new bool[num_solid_bonds]);
-    for (unsigned int bond(0); bond < num_solid_bonds; bond++)
+    for (unsigned int i(0); i < num_query_points; i++)
     {
-        const unsigned int i(solid_nlist.getNeighbors()(bond, 0));
-        const unsigned int j(solid_nlist.getNeighbors()(bond, 1));
-        neighbor_count_filter[bond] = (m_number_of_connections[i] >= m_solid_threshold
-                                       && m_number_of_connections[j] >= m_solid_threshold);
+        for (unsigned int bond(solid_nlist.find_first_index(i)); bond < solid_nlist.find_first_index(i + 1);
+             bond++)
+        {
+            const unsigned int j(solid_nlist.getPointIndices()[bond]);
+            neighbor_count_filter[bond] = (m_number_of_connections[i] >= m_solid_threshold
+                                           && m_number_of_connections[j] >= m_solid_threshold);
+        }
     }
     freud::locality::NeighborList solid_neighbor_nlist(solid_nlist);
     solid_neighbor_nlist.filter(neighbor_count_filter.get());
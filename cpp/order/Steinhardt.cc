@@ -92,6 +92,7 @@ void Steinhardt::baseCompute(const freud::locality::NeighborList* nlist,
     // For consistency, this reset is done here regardless of whether the array
     // is populated in baseCompute or computeAve.
     m_qlm_local.reset();
+    const auto qlmi = m_qlmi.view<2>();
     freud::locality::loopOverNeighborsIterator(
         points, points->getPoints(), m_Np, qargs, nlist,
         [=](size_t i, std::shared_ptr<freud::locality::NeighborPerPointIterator> ppiter) {
@@ -125,7 +126,7 @@ void Steinhardt::baseCompute(const freud::locality::NeighborList* nlist,
 
                 for (unsigned int k = 0; k < m_num_ms; ++k)
                 {
-                    m_qlmi({static_cast<unsigned int>(i), k}) += weight * Ylm[k];
+                    qlmi(i, k) += weight * Ylm[k];
                 }
                 total_weight += weight;
             } // End loop going over neighbor bonds
@@ -133,15 +134,13 @@ void Steinhardt::baseCompute(const freud::locality::NeighborList* nlist,
             // Normalize!
             for (unsigned int k = 0; k < m_num_ms; ++k)
             {
-                // Cache the index for efficiency.
-                const unsigned int index = m_qlmi.getIndex({static_cast<unsigned int>(i), k});
-                m_qlmi[index] /= total_weight;
+                qlmi(i, k) /= total_weight;
                 // Add the norm, which is the (complex) squared magnitude
-                m_qli[i] += norm(m_qlmi[index]);
+                m_qli[i] += norm(qlmi(i, k));
                 // This array gets populated by computeAve in the averaging case.
                 if (!m_average)
                 {
-                    m_qlm_local.local()[k] += m_qlmi[index] / float(m_Np);
+                    m_qlm_local.local()[k] += qlmi(i, k) / float(m_Np);
                 }
             }
             m_qli[i] *= normalizationfactor;
@@ -159,11 +158,18 @@ void Steinhardt::computeAve(const freud::locality::NeighborList* nlist,
     }
 
     const float normalizationfactor = 4 * M_PI / m_num_ms;
+    const auto qlmi = m_qlmi.view<2>();
+    const auto qlmi_ave = m_qlmiAve.view<2>();
 
     freud::locality::loopOverNeighborsIterator(
         points, points->getPoints(), m_Np, qargs, nlist,
         [=](size_t i, std::shared_ptr<freud::locality::NeighborPerPointIterator> ppiter) {
             unsigned int neighborcount(1);
+            // The NeighborList iterator is reset for each neighbor rather
+            // than allocated, so it is shared through a non-owning pointer.
+            locality::NeighborListPerPointIterator nlist_iter;
+            std::shared_ptr<freud::locality::NeighborPerPointIterator> nlist_iter_ptr(
+                std::shared_ptr<freud::locality::NeighborPerPointIterator>(), &nlist_iter);
             for (freud::locality::NeighborBond nb1 = ppiter->next(); !ppiter->end(); nb1 = ppiter->next())
             {
                 // Since we need to find neighbors of neighbors, we need to add some extra logic here to
@@ -171,8 +177,8 @@ void Steinhardt::computeAve(const freud::locality::NeighborList* nlist,
                 std::shared_ptr<freud::locality::NeighborPerPointIterator> ns_neighbors_iter;
                 if (nlist != NULL)
                 {
-                    ns_neighbors_iter
-                        = std::make_shared<locality::NeighborListPerPointIterator>(nlist, nb1.point_idx);
+                    nlist_iter.reset(nlist, nb1.point_idx);
+                    ns_neighbors_iter = nlist_iter_ptr;
                 }
                 else
                 {
@@ -184,10 +190,8 @@ void Steinhardt::computeAve(const freud::locality::NeighborList* nlist,
                 {
                     for (unsigned int k = 0; k < m_num_ms; ++k)
                     {
-                        // Adding all the qlm of the neighbors. We use the
-                        // vector function signature for indexing into the
-                        // arrays for speed.
-                        m_qlmiAve({static_cast<unsigned int>(i), k}) += m_qlmi({nb2.point_idx, k});
+                        // Adding all the qlm of the neighbors.
+                        qlmi_ave(i, k) += qlmi(nb2.point_idx, k);
                     }
                     neighborcount++;
                 } // End loop over particle neighbor's bonds
@@ -196,14 +200,12 @@ void Steinhardt::computeAve(const freud::locality::NeighborList* nlist,
             // Normalize!
             for (unsigned int k = 0; k < m_num_ms; ++k)
             {
-                // Cache the index for efficiency.
-                const unsigned int index = m_qlmiAve.getIndex({static_cast<unsigned int>(i), k});
                 // Adding the qlm of the particle i itself
-                m_qlmiAve[index] += m_qlmi[index];
-                m_qlmiAve[index] /= neighborcount;
-                m_qlm_local.local()[k] += m_qlmiAve[index] / float(m_Np);
+                qlmi_ave(i, k) += qlmi(i, k);
+                qlmi_ave(i, k) /= neighborcount;
+                m_qlm_local.local()[k] += qlmi_ave(i, k) / float(m_Np);
                 // Add the norm, which is the complex squared magnitude
-                m_qliAve[i] += norm(m_qlmiAve[index]);
+                m_qliAve[i] += norm(qlmi_ave(i, k));
             }
             m_qliAve[i] *= normalizationfactor;
             m_qliAve[i] = std::sqrt(m_qliAve[i]);
@@ -247,10 +249,11 @@ void Steinhardt::aggregatewl(util::ManagedArray<float>& target,
 {
     auto wigner3jvalues = getWigner3j(m_l);
     const float normalizationfactor = float(4 * M_PI / m_num_ms);
+    const auto source_view = source.view<2>();
     util::forLoopWrapper(0, m_Np, [&](size_t begin, size_t end) {
         for (size_t i = begin; i < end; ++i)
         {
-            target[i] = reduceWigner3j(&(source({static_cast<unsigned int>(i), 0})), m_l, wigner3jvalues);
+            target[i] = reduceWigner3j(&source_view(i, 0), m_l, wigner3jvalues);
             if (m_wl_normalize)
             {
                 const float normalization = std::sqrt(normalizationfactor) / normalization_source[i];
@@ -32,8 +32,8 @@ PMFTXY::PMFTXY(float x_max, float y_max, unsigned int n_x, unsigned int n_y) : P
 
     // Construct the Histogram object that will be used to keep track of counts of bond distances found.
     BHAxes axes;
-    axes.push_back(std::make_shared<util::RegularAxis>(n_x, -x_max, x_max));
-    axes.push_back(std::make_shared<util::RegularAxis>(n_y, -y_max, y_max));
+    axes.push_back(util::RegularAxis(n_x, -x_max, x_max));
+    axes.push_back(util::RegularAxis(n_y, -y_max, y_max));
     m_histogram = BondHistogram(axes);
     m_local_histograms = BondHistogram::ThreadLocalHistogram(m_histogram);
 }
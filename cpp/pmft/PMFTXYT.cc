@@ -36,9 +36,9 @@ PMFTXYT::PMFTXYT(float x_max, float y_max, unsigned int n_x, unsigned int n_y, u
 
     // Construct the Histogram object that will be used to keep track of counts of bond distances found.
     BondHistogram::Axes axes;
-    axes.push_back(std::make_shared<util::RegularAxis>(n_x, -x_max, x_max));
-    axes.push_back(std::make_shared<util::RegularAxis>(n_y, -y_max, y_max));
-    axes.push_back(std::make_shared<util::RegularAxis>(n_t, 0, constants::TWO_PI));
+    axes.push_back(util::RegularAxis(n_x, -x_max, x_max));
+    axes.push_back(util::RegularAxis(n_y, -y_max, y_max));
+    axes.push_back(util::RegularAxis(n_t, 0, constants::TWO_PI));
     m_histogram = BondHistogram(axes);
     m_local_histograms = BondHistogram::ThreadLocalHistogram(m_histogram);
 }
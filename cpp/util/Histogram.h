@@ -1,13 +1,19 @@
 #ifndef HISTOGRAM_H
 #define HISTOGRAM_H
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <vector>
 #ifdef __SSE2__
 #include <emmintrin.h>
 #endif
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
 #include <sstream>
 #include <tbb/tbb.h>
+#include <type_traits>
 #include <utility>
 
 #include "ManagedArray.h"
@@ -15,6 +21,12 @@
 
 namespace freud { namespace util {
 
+//! Number of values binned at once by the batched histogram functions.
+/*! Batches are small enough that the bins of a batch fit in a few kilobytes
+ *  on the stack, but large enough to amortize the overhead of each batch.
+ */
+const unsigned int HISTOGRAM_BATCH_SIZE = 256;
+
 //! Weight to add to a histogram.
 /*! For histograms that are not simple counts, a Weight instance may be passed
  * in to indicate what value should be added to a bin. If not provided,
@@ -109,9 +121,11 @@ protected:
  * linearly spaced bins between two boundaries. These axes can be specified a
  * relatively small set of parameter and are very efficient to bin with
  * defining them. Given a value along the Axis, the Axis can compute the bin
- * within which this value falls.
+ * within which this value falls. Histograms hold RegularAxis instances by
+ * value, and since the class is final, calls to bin are resolved statically
+ * and can be inlined.
  */
-class RegularAxis : public Axis
+class RegularAxis final : public Axis
 {
 public:
     RegularAxis(size_t nbins, float min, float max) : Axis(nbins, min, max)
@@ -140,7 +154,7 @@ public:
      *
      * \return The index of the bin the value falls into.
      */
-    virtual size_t bin(const float& value) const
+    inline virtual size_t bin(const float& value) const
     {
         // Since we're using an unsigned int cast for truncation, we must
         // ensure that we will be working with a positive number or we will
@@ -163,6 +177,60 @@ public:
             return bin;
     }
 
+    //! Find the bins of a block of values along this axis.
+    /*! This function computes the same bins as bin, but processes several
+     * values at once using the widest vector instructions the code is
+     * compiled for. Values outside the axis (including NaN) are assigned
+     * Axis::OVERFLOW_BIN.
+     *
+     * \param values The values to bin
+     * \param n The number of values
+     * \param bins Output array of n bins
+     */
+    void binBatch(const float* values, size_t n, unsigned int* bins) const
+    {
+        // Clamping the scaled value to the last bin before truncating
+        // handles rounding up to m_nbins like bin does.
+        const float last_bin = static_cast<float>(m_nbins - 1);
+        size_t i = 0;
+#if defined(__AVX__)
+        const __m256 min_v = _mm256_set1_ps(m_min), max_v = _mm256_set1_ps(m_max);
+        const __m256 dr_inv_v = _mm256_set1_ps(m_dr_inv), last_bin_v = _mm256_set1_ps(last_bin);
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256 v = _mm256_loadu_ps(values + i);
+            const __m256 outside = _mm256_or_ps(_mm256_cmp_ps(v, min_v, _CMP_NGE_UQ),
+                                                _mm256_cmp_ps(v, max_v, _CMP_NLT_UQ));
+            const __m256 val = _mm256_min_ps(_mm256_mul_ps(_mm256_sub_ps(v, min_v), dr_inv_v), last_bin_v);
+            const __m256 bin = _mm256_castsi256_ps(_mm256_cvttps_epi32(val));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bins + i),
+                                _mm256_castps_si256(_mm256_or_ps(bin, outside)));
+        }
+#elif defined(__SSE2__)
+        const __m128 min_v = _mm_set1_ps(m_min), max_v = _mm_set1_ps(m_max);
+        const __m128 dr_inv_v = _mm_set1_ps(m_dr_inv), last_bin_v = _mm_set1_ps(last_bin);
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(values + i);
+            const __m128 outside = _mm_or_ps(_mm_cmpnge_ps(v, min_v), _mm_cmpnlt_ps(v, max_v));
+            const __m128 val = _mm_min_ps(_mm_mul_ps(_mm_sub_ps(v, min_v), dr_inv_v), last_bin_v);
+            const __m128 bin = _mm_castsi128_ps(_mm_cvttps_epi32(val));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bins + i), _mm_castps_si128(_mm_or_ps(bin, outside)));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            if (!(values[i] >= m_min && values[i] < m_max))
+            {
+                bins[i] = OVERFLOW_BIN;
+            }
+            else
+            {
+                bins[i] = static_cast<unsigned int>(std::min((values[i] - m_min) * m_dr_inv, last_bin));
+            }
+        }
+    }
+
 protected:
     float m_dr;     //!< Gap between bins
     float m_dr_inv; //!< Inverse gap between bins
@@ -181,24 +249,37 @@ protected:
 template<typename T> class Histogram
 {
 public:
+    typedef std::vector<RegularAxis> Axes;
+    typedef Axes::const_iterator AxisIterator;
+
     //! A container for thread-local copies of a provided histogram.
     /*! This container implements the simplest method of enabling parallel-safe
      * accumulation, namely the creation of separate instances on each thread.
      * Thread local histograms can be accumulated later using the
      * reduceOverThreads functions in the Histogram class.
      *
-     * To simplify the implementation and avoid unnecessary copies, the thread
-     * local copies all share the same axes (because the axes are stored as
-     * arrays of shared_ptrs in the Histogram class). This should cause no
-     * problems, but can be refactored if needed.
+     * Each thread local copy holds its own copy of the axes, which are small
+     * compared to the bin counts. Values passed to operator() are buffered on
+     * each thread and binned in batches of HISTOGRAM_BATCH_SIZE with
+     * accumulateBatch. Partially filled buffers are binned when the histograms
+     * are reduced.
+     *
+     * Since every thread holds a full copy of the bin counts, the memory used
+     * by histograms with many bins grows quickly with the number of threads.
+     * Such histograms can instead be shared between all threads (see
+     * setShared), in which case the buffered values are added to a single
+     * array of bin counts with atomic increments. The counts of integral bins
+     * are the same in both cases.
      */
     class ThreadLocalHistogram
     {
     public:
-        ThreadLocalHistogram() {}
+        ThreadLocalHistogram() : m_shared(false) {}
 
         ThreadLocalHistogram(Histogram histogram)
-            : m_local_histograms([histogram]() { return Histogram(histogram.m_axes); })
+            : m_local_histograms([histogram]() { return Histogram(histogram.m_axes); }),
+              m_buffers([histogram]() { return Buffer(histogram.m_axes.size()); }), m_axes(histogram.m_axes),
+              m_shared(false)
         {}
 
         typedef typename tbb::enumerable_thread_specific<Histogram>::const_iterator const_iterator;
@@ -230,58 +311,242 @@ public:
             return m_local_histograms.local();
         }
 
+        //! Reset the histograms.
+        /*! The thread local histograms are released rather than zeroed, so
+         *  that threads that do not bin any values before the next reduction
+         *  are skipped when reducing.
+         */
         void reset()
         {
-            for (auto hist = m_local_histograms.begin(); hist != m_local_histograms.end(); ++hist)
+            m_local_histograms.clear();
+            for (auto buffer = m_buffers.begin(); buffer != m_buffers.end(); ++buffer)
+            {
+                buffer->size = 0;
+            }
+            m_shared_bin_counts.reset();
+        }
+
+        //! Set whether all threads bin values into a single shared histogram.
+        /*! The shared bin counts are only allocated once sharing is first
+         *  enabled. Counts accumulated before switching between thread local
+         *  and shared histograms are kept, since all counts are summed when
+         *  the histograms are reduced. Only histograms with integral bin
+         *  counts can be shared.
+         */
+        void setShared(bool shared)
+        {
+            if (shared && !std::is_integral<T>::value)
+            {
+                throw std::invalid_argument(
+                    "Only histograms with integral bin counts can be shared between threads.");
+            }
+            if (shared && m_shared_bin_counts.size() == 0)
             {
-                hist->reset();
+                std::vector<size_t> sizes;
+                for (AxisIterator it = m_axes.begin(); it != m_axes.end(); it++)
+                    sizes.push_back(it->size());
+                m_shared_bin_counts.prepare(sizes);
             }
+            m_shared = shared;
         }
 
-        //! Dispatch to thread local histogram.
+        //! Return whether all threads bin values into a single shared histogram.
+        bool isShared() const
+        {
+            return m_shared;
+        }
+
+        //! Buffer values for the thread local histogram.
+        /*! The values are binned once HISTOGRAM_BATCH_SIZE of them have been
+         *  buffered on this thread.
+         */
         template<typename... FloatsOrWeight> void operator()(FloatsOrWeight... values)
         {
-            m_local_histograms.local()(values...);
+            static_assert(sizeof...(FloatsOrWeight) <= MAX_BUFFERED_AXES + 1,
+                          "Too many values for a ThreadLocalHistogram");
+            Buffer& buffer = m_buffers.local();
+            buffer.weights[buffer.size] = 1;
+            const size_t num_values = storeValues(buffer, 0, values...);
+            if (num_values != buffer.num_axes)
+            {
+                m_local_histograms.local().throwDimensionError(num_values);
+            }
+            if (++buffer.size == HISTOGRAM_BATCH_SIZE)
+            {
+                flush(buffer);
+            }
         }
 
-        //! Dispatch to thread local histogram.
+        //! Dispatch to thread local or shared histogram.
         void increment(size_t value_bin, T weight = 1)
         {
-            m_local_histograms.local().increment(value_bin, weight);
+            if (m_shared)
+            {
+                if (value_bin != Axis::OVERFLOW_BIN)
+                {
+                    atomicAdd(m_shared_bin_counts.get()[value_bin], weight);
+                }
+            }
+            else
+            {
+                m_local_histograms.local().increment(value_bin, weight);
+            }
         }
 
-        // Reduce over histograms into the result array.
+        //! Reduce over histograms into the result array.
+        /*! The reduction is blocked into tiles of the result (see reduceArrays).
+         */
         void reduceInto(ManagedArray<T>& result)
         {
+            // The histograms are summed, so the values left in the buffers of
+            // all threads can be binned into any one of them.
+            for (auto buffer = m_buffers.begin(); buffer != m_buffers.end(); ++buffer)
+            {
+                flush(*buffer);
+            }
+
             result.reset();
-            util::forLoopWrapper(0, result.size(), [=, &result](size_t begin, size_t end) {
-                for (size_t i = begin; i < end; ++i)
-                {
-                    for (auto hist = m_local_histograms.begin(); hist != m_local_histograms.end(); ++hist)
+            std::vector<const T*> local_bin_counts;
+            for (auto hist = m_local_histograms.begin(); hist != m_local_histograms.end(); ++hist)
+            {
+                local_bin_counts.push_back(hist->m_bin_counts.get());
+            }
+            reduceArrays(result.get(), local_bin_counts, result.size());
+
+            if (m_shared_bin_counts.size() != 0)
+            {
+                const SharedCount* shared_bin_counts = m_shared_bin_counts.get();
+                T* result_bin_counts = result.get();
+                util::forLoopWrapper(0, result.size(), [=](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i)
                     {
-                        result[i] += hist->m_bin_counts[i];
+                        result_bin_counts[i] += atomicLoad(shared_bin_counts[i]);
                     }
-                }
-            });
+                });
+            }
         }
 
     protected:
+        //! Maximum number of axes of histograms filled through operator().
+        static const unsigned int MAX_BUFFERED_AXES = 3;
+
+        //! Values waiting to be binned, stored by axis.
+        struct Buffer
+        {
+            Buffer() : num_axes(0), size(0) {}
+
+            Buffer(size_t num_axes) : num_axes(num_axes), size(0) {}
+
+            float values[MAX_BUFFERED_AXES][HISTOGRAM_BATCH_SIZE]; //!< The values along each axis.
+            T weights[HISTOGRAM_BATCH_SIZE];                       //!< The weight of each point.
+            size_t num_axes;                                       //!< The number of values per point.
+            unsigned int size;                                     //!< The number of buffered points.
+        };
+
+        //! The type of the shared bin counts.
+        /*! Only integral bin counts can be shared, since atomic additions
+         *  are not available for other types.
+         */
+        typedef typename std::conditional<std::is_integral<T>::value, std::atomic<T>, T>::type SharedCount;
+
+        //! Atomically add a weight to a shared bin count.
+        static void atomicAdd(std::atomic<T>& count, T weight)
+        {
+            count.fetch_add(weight, std::memory_order_relaxed);
+        }
+
+        //! Atomically read a shared bin count.
+        static T atomicLoad(const std::atomic<T>& count)
+        {
+            return count.load(std::memory_order_relaxed);
+        }
+
+        //! Add a weight to a bin count that cannot be shared.
+        static void atomicAdd(T& count, T weight)
+        {
+            count += weight;
+        }
+
+        //! Read a bin count that cannot be shared.
+        static T atomicLoad(const T& count)
+        {
+            return count;
+        }
+
+        //! Bin the buffered values into the thread local or shared histogram and empty the buffer.
+        void flush(Buffer& buffer)
+        {
+            if (buffer.size == 0)
+            {
+                return;
+            }
+            const float* values[MAX_BUFFERED_AXES] = {buffer.values[0], buffer.values[1], buffer.values[2]};
+            if (m_shared)
+            {
+                unsigned int bins[HISTOGRAM_BATCH_SIZE];
+                unsigned int indices[HISTOGRAM_BATCH_SIZE];
+                const size_t num_inside = binBatch(m_axes, values, 0, buffer.size, bins, indices);
+                SharedCount* counts = m_shared_bin_counts.get();
+                for (size_t i = 0; i < num_inside; ++i)
+                {
+                    atomicAdd(counts[bins[i]], buffer.weights[indices[i]]);
+                }
+            }
+            else
+            {
+                m_local_histograms.local().accumulateBatch(values, buffer.num_axes, buffer.size,
+                                                           buffer.weights);
+            }
+            buffer.size = 0;
+        }
+
+        //! The base case for storing the values provided to operator().
+        /*! The recursive functions store each float value in the buffer of
+         * the next axis and a Weight in the buffer of weights.
+         *
+         * \return The number of float values.
+         */
+        static size_t storeValues(Buffer& /* buffer */, size_t ax_idx)
+        {
+            return ax_idx;
+        }
+
+        //! The recursive case for storing a float value (see base-case function docs).
+        template<typename... FloatsOrWeight>
+        static size_t storeValues(Buffer& buffer, size_t ax_idx, float value, FloatsOrWeight... values)
+        {
+            if (ax_idx < MAX_BUFFERED_AXES)
+            {
+                buffer.values[ax_idx][buffer.size] = value;
+            }
+            return storeValues(buffer, ax_idx + 1, values...);
+        }
+
+        //! The recursive case for storing a Weight (see base-case function docs).
+        template<typename... FloatsOrWeight>
+        static size_t storeValues(Buffer& buffer, size_t ax_idx, Weight<T> weight, FloatsOrWeight... values)
+        {
+            buffer.weights[buffer.size] = weight.value;
+            return storeValues(buffer, ax_idx, values...);
+        }
+
         tbb::enumerable_thread_specific<Histogram<T>>
-            m_local_histograms; //!< The thread-local copies of m_histogram.
+            m_local_histograms;                         //!< The thread-local copies of m_histogram.
+        tbb::enumerable_thread_specific<Buffer> m_buffers; //!< The thread-local buffers of values.
+        Axes m_axes;                                       //!< The axes of the histogram.
+        bool m_shared; //!< Whether values are binned into the shared histogram.
+        ManagedArray<SharedCount> m_shared_bin_counts; //!< The bin counts shared by all threads.
     };
 
-    typedef std::vector<std::shared_ptr<Axis>> Axes;
-    typedef Axes::const_iterator AxisIterator;
-
     //! Default constructor
     Histogram() {}
 
     //! Constructor
-    Histogram(std::vector<std::shared_ptr<Axis>> axes) : m_axes(axes)
+    Histogram(Axes axes) : m_axes(axes)
     {
         std::vector<size_t> sizes;
         for (AxisIterator it = m_axes.begin(); it != m_axes.end(); it++)
-            sizes.push_back((*it)->size());
+            sizes.push_back(it->size());
         m_bin_counts = ManagedArray<T>(sizes);
     }
 
@@ -307,17 +572,83 @@ public:
     ~Histogram() {};
 
     //! Bin value and update the histogram count.
+    /*! The values along each axis may be followed by a Weight to add to the
+     *  bin instead of 1.
+     */
     template<typename... FloatsOrWeight> void operator()(FloatsOrWeight... values)
     {
-        std::pair<std::vector<float>, Weight<T>> value_vector = getValueVector(values...);
-        size_t value_bin = bin(value_vector.first);
+        Weight<T> weight;
+        size_t value_bin = binValues(0, 0, weight, values...);
         // Check for sentinel to avoid overflow.
         if (value_bin != Axis::OVERFLOW_BIN)
         {
-            m_bin_counts[value_bin] += value_vector.second.value;
+            m_bin_counts[value_bin] += weight.value;
         }
     }
 
+    //! Bin a block of points and update the histogram counts.
+    /*! The bins of HISTOGRAM_BATCH_SIZE points at a time are computed with
+     *  binBatch before the counts are incremented. The counts are
+     *  incremented one point at a time, so points of a batch that fall into
+     *  the same bin cannot conflict as they would in a vectorized scatter.
+     *
+     *  \param values Array of num_values pointers to the n values along each axis.
+     *  \param num_values The number of values of each point, which must match the number of axes.
+     *  \param n The number of points.
+     *  \param weights The weight of each point, or NULL to count each point once.
+     */
+    void accumulateBatch(const float* const* values, size_t num_values, size_t n, const T* weights = NULL)
+    {
+        if (num_values != m_axes.size())
+        {
+            throwDimensionError(num_values);
+        }
+        T* counts = m_bin_counts.get();
+        unsigned int bins[HISTOGRAM_BATCH_SIZE];
+        unsigned int indices[HISTOGRAM_BATCH_SIZE];
+        for (size_t batch_begin = 0; batch_begin < n; batch_begin += HISTOGRAM_BATCH_SIZE)
+        {
+            const size_t batch_size = std::min(n - batch_begin, size_t(HISTOGRAM_BATCH_SIZE));
+            const size_t num_inside = binBatch(m_axes, values, batch_begin, batch_size, bins, indices);
+            if (weights != NULL)
+            {
+                const T* batch_weights = weights + batch_begin;
+                for (size_t i = 0; i < num_inside; ++i)
+                {
+                    counts[bins[i]] += batch_weights[indices[i]];
+                }
+            }
+            else
+            {
+                for (size_t i = 0; i < num_inside; ++i)
+                {
+                    counts[bins[i]] += 1;
+                }
+            }
+        }
+    }
+
+    //! Bin a block of 1D points (see accumulateBatch above).
+    void accumulateBatch(const float* x, size_t n, const T* weights = NULL)
+    {
+        const float* values[] = {x};
+        accumulateBatch(values, 1, n, weights);
+    }
+
+    //! Bin a block of 2D points (see accumulateBatch above).
+    void accumulateBatch(const float* x, const float* y, size_t n, const T* weights = NULL)
+    {
+        const float* values[] = {x, y};
+        accumulateBatch(values, 2, n, weights);
+    }
+
+    //! Bin a block of 3D points (see accumulateBatch above).
+    void accumulateBatch(const float* x, const float* y, const float* z, size_t n, const T* weights = NULL)
+    {
+        const float* values[] = {x, y, z};
+        accumulateBatch(values, 3, n, weights);
+    }
+
     //! Increment specified linear bin (with a specified weight if desired).
     void increment(size_t value_bin, T weight = 1)
     {
@@ -329,33 +660,36 @@ public:
     }
 
     //! Find the bin of a value.
-    /*! Bins are first computed along each axis of the histogram. These bins
-     *  are then combined into a single linear index using the underlying
-     *  ManagedArray.
+    /*! Bins are computed along each axis of the histogram and combined into a
+     *  single linear index in row-major order.
      */
-    size_t bin(std::vector<float> values) const
+    size_t bin(const std::vector<float>& values) const
     {
         if (values.size() != m_axes.size())
         {
-            std::ostringstream msg;
-            msg << "This Histogram is " << m_axes.size() << "-dimensional, but " << values.size()
-                << " values were provided in bin" << std::endl;
-            throw std::invalid_argument(msg.str());
+            throwDimensionError(values.size());
         }
-        // First bin the values along each axis.
-        std::vector<size_t> ax_bins;
+        size_t value_bin = 0;
         for (unsigned int ax_idx = 0; ax_idx < m_axes.size(); ++ax_idx)
         {
-            size_t bin_i = m_axes[ax_idx]->bin(values[ax_idx]);
+            size_t bin_i = m_axes[ax_idx].bin(values[ax_idx]);
             // Immediately return sentinel if any bin is out of bounds.
             if (bin_i == Axis::OVERFLOW_BIN)
             {
                 return Axis::OVERFLOW_BIN;
             }
-            ax_bins.push_back(bin_i);
+            value_bin = value_bin * m_axes[ax_idx].size() + bin_i;
         }
+        return value_bin;
+    }
 
-        return m_bin_counts.getIndex(ax_bins);
+    //! Find the bin of a value given as one float per axis.
+    /*! Unlike the std::vector overload, this function does not allocate.
+     */
+    template<typename... Floats> size_t bin(float value, Floats... values) const
+    {
+        Weight<T> weight;
+        return binValues(0, 0, weight, value, values...);
     }
 
     //! Get the computed histogram.
@@ -384,7 +718,7 @@ public:
         std::vector<std::vector<float>> bins(m_axes.size());
         for (unsigned int i = 0; i < m_axes.size(); ++i)
         {
-            bins[i] = m_axes[i]->getBinEdges();
+            bins[i] = m_axes[i].getBinEdges();
         }
         return bins;
     }
@@ -397,7 +731,7 @@ public:
         std::vector<std::vector<float>> bins(m_axes.size());
         for (unsigned int i = 0; i < m_axes.size(); ++i)
         {
-            bins[i] = m_axes[i]->getBinCenters();
+            bins[i] = m_axes[i].getBinCenters();
         }
         return bins;
     }
@@ -408,7 +742,7 @@ public:
         std::vector<std::pair<float, float>> bounds(m_axes.size());
         for (unsigned int i = 0; i < m_axes.size(); ++i)
         {
-            bounds[i] = std::pair<float, float>(m_axes[i]->getMin(), m_axes[i]->getMax());
+            bounds[i] = std::pair<float, float>(m_axes[i].getMin(), m_axes[i].getMax());
         }
         return bounds;
     }
@@ -419,7 +753,7 @@ public:
         std::vector<size_t> sizes(m_axes.size());
         for (unsigned int i = 0; i < m_axes.size(); ++i)
         {
-            sizes[i] = m_axes[i]->size();
+            sizes[i] = m_axes[i].size();
         }
         return sizes;
     }
@@ -477,45 +811,105 @@ public:
     }
 
 protected:
-    std::vector<std::shared_ptr<Axis>> m_axes; //!< The axes.
-    ManagedArray<T> m_bin_counts;              //!< Counts for each bin
+    Axes m_axes;                  //!< The axes.
+    ManagedArray<T> m_bin_counts; //!< Counts for each bin
+
+    //! Throw an error for a number of values that does not match the number of axes.
+    void throwDimensionError(size_t num_values) const
+    {
+        std::ostringstream msg;
+        msg << "This Histogram is " << m_axes.size() << "-dimensional, but " << num_values
+            << " values were provided in bin" << std::endl;
+        throw std::invalid_argument(msg.str());
+    }
 
-    //! The base case for type float when constructing a vector of values provided to operator().
-    /*! This function and the accompanying recursive function below employ
-     * variadic templating to accept an arbitrary set of float values and
-     * construct a vector out of them.
+    //! Find the linear bins of a batch of points.
+    /*! The bins are computed along each axis with RegularAxis::binBatch and
+     * combined into linear bins in row-major order. Points outside the
+     * histogram are left out of the output, so that the counts of the
+     * remaining points can be incremented without branching.
+     *
+     * \param axes The axes of the histogram.
+     * \param values Array of pointers to the values along each axis.
+     * \param batch_begin The index of the first point of the batch.
+     * \param batch_size The number of points, at most HISTOGRAM_BATCH_SIZE.
+     * \param bins Output array of the linear bins of the points inside the histogram.
+     * \param indices Output array of the indices within the batch of the points inside the histogram.
+     *
+     * \return The number of points inside the histogram.
      */
-    std::pair<std::vector<float>, Weight<T>> getValueVector(float value) const
+    static size_t binBatch(const Axes& axes, const float* const* values, size_t batch_begin,
+                           size_t batch_size, unsigned int* bins, unsigned int* indices)
     {
-        return {{value}, Weight<T>()};
+        unsigned int axis_bins[HISTOGRAM_BATCH_SIZE];
+        axes[0].binBatch(values[0] + batch_begin, batch_size, bins);
+        for (size_t ax_idx = 1; ax_idx < axes.size(); ++ax_idx)
+        {
+            axes[ax_idx].binBatch(values[ax_idx] + batch_begin, batch_size, axis_bins);
+            const unsigned int axis_size = static_cast<unsigned int>(axes[ax_idx].size());
+            for (size_t i = 0; i < batch_size; ++i)
+            {
+                bins[i] = (bins[i] == Axis::OVERFLOW_BIN || axis_bins[i] == Axis::OVERFLOW_BIN)
+                    ? static_cast<unsigned int>(Axis::OVERFLOW_BIN)
+                    : bins[i] * axis_size + axis_bins[i];
+            }
+        }
+
+        size_t num_inside = 0;
+        for (size_t i = 0; i < batch_size; ++i)
+        {
+            bins[num_inside] = bins[i];
+            indices[num_inside] = static_cast<unsigned int>(i);
+            num_inside += (bins[i] != Axis::OVERFLOW_BIN);
+        }
+        return num_inside;
     }
 
-    //! The base case for type Weight when constructing a vector of values provided to operator().
-    /*! This function and the accompanying recursive function below employ
-     * variadic templating to accept an arbitrary set of float values and
-     * construct a vector out of them.
+    //! The base case for computing the bin of the values provided to operator().
+    /*! This function and the accompanying recursive functions below employ
+     * variadic templating to bin an arbitrary set of float values, one per
+     * axis, and accumulate their linear bin index in row-major order without
+     * building any intermediate arrays. A Weight among the values is stored
+     * in weight instead of being binned.
+     *
+     * \param value_bin The linear bin of the values along the preceding axes.
+     * \param ax_idx The axis of the next value.
+     * \param weight The weight found among the values.
      */
-    std::pair<std::vector<float>, Weight<T>> getValueVector(Weight<T> weight) const
+    size_t binValues(size_t value_bin, size_t ax_idx, Weight<T>& /* weight */) const
     {
-        return {{}, weight};
+        if (ax_idx != m_axes.size())
+        {
+            throwDimensionError(ax_idx);
+        }
+        return value_bin;
     }
 
-    //! The recursive case for constructing a vector of values (see base-case function docs).
+    //! The recursive case for binning a float value (see base-case function docs).
     template<typename... FloatsOrWeight>
-    std::pair<std::vector<float>, Weight<T>> getValueVector(float value, FloatsOrWeight... values) const
+    size_t binValues(size_t value_bin, size_t ax_idx, Weight<T>& weight, float value,
+                     FloatsOrWeight... values) const
     {
-        std::pair<std::vector<float>, Weight<T>> tmp = getValueVector(values...);
-        tmp.first.insert(tmp.first.begin(), value);
-        return tmp;
+        if (ax_idx >= m_axes.size())
+        {
+            throwDimensionError(ax_idx + 1);
+        }
+        const size_t bin_i = m_axes[ax_idx].bin(value);
+        // Immediately return sentinel if any bin is out of bounds.
+        if (bin_i == Axis::OVERFLOW_BIN)
+        {
+            return Axis::OVERFLOW_BIN;
+        }
+        return binValues(value_bin * m_axes[ax_idx].size() + bin_i, ax_idx + 1, weight, values...);
     }
 
-    //! The recursive case for constructing a vector of values (see base-case function docs).
+    //! The recursive case for a Weight (see base-case function docs).
     template<typename... FloatsOrWeight>
-    std::pair<std::vector<float>, Weight<T>> getValueVector(Weight<T> weight, FloatsOrWeight... values) const
+    size_t binValues(size_t value_bin, size_t ax_idx, Weight<T>& weight, Weight<T> value_weight,
+                     FloatsOrWeight... values) const
     {
-        std::pair<std::vector<float>, Weight<T>> tmp = getValueVector(values...);
-        tmp.second = weight;
-        return tmp;
+        weight = value_weight;
+        return binValues(value_bin, ax_idx, weight, values...);
     }
 };
 
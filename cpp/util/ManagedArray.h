@@ -1,9 +1,11 @@
 #ifndef MANAGED_ARRAY_H
 #define MANAGED_ARRAY_H
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 /*! \file ManagedArray.h
@@ -12,6 +14,103 @@
 
 namespace freud { namespace util {
 
+//! Lightweight view of the data of a ManagedArray with a fixed number of dimensions.
+/*! Indexing a view computes the linear index from strides cached when the
+ *  view is created, without building vectors of indices. Bounds are only
+ *  checked in debug builds (when NDEBUG is not defined), so views are meant
+ *  for the inner loops of computes. A view does not keep the data alive and
+ *  is invalidated when the array it was created from is reallocated, e.g. by
+ *  ManagedArray::prepare.
+ */
+template<typename T, unsigned int Rank> class ManagedArrayView
+{
+public:
+    //! Constructor
+    /*! \param data Pointer to the data of the array.
+     *  \param shape Shape of the array, which must have Rank dimensions.
+     */
+    ManagedArrayView(T* data, const std::vector<size_t>& shape) : m_data(data), m_size(1)
+    {
+        if (shape.size() != Rank)
+        {
+            throw std::invalid_argument("Incorrect number of dimensions for this array view.");
+        }
+        for (int i = Rank - 1; i >= 0; --i)
+        {
+            m_shape[i] = shape[i];
+            m_strides[i] = m_size;
+            m_size *= shape[i];
+        }
+    }
+
+    //! Index into the array with one index per dimension.
+    template<typename... Ints> inline T& operator()(Ints... indices) const
+    {
+        static_assert(sizeof...(Ints) == Rank, "Incorrect number of indices for this array view.");
+        return m_data[linearIndex(0, indices...)];
+    }
+
+    //! Index into the flattened array.
+    inline T& operator[](size_t index) const
+    {
+#ifndef NDEBUG
+        if (index >= m_size)
+        {
+            std::ostringstream msg;
+            msg << "Attempted to access index " << index << " in an array of size " << m_size << std::endl;
+            throw std::invalid_argument(msg.str());
+        }
+#endif
+        return m_data[index];
+    }
+
+    //! Get the size of the array.
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    //! Get the size of the array in one dimension.
+    size_t shape(unsigned int dimension) const
+    {
+        return m_shape[dimension];
+    }
+
+    //! Get the pointer to the data of the array.
+    T* data() const
+    {
+        return m_data;
+    }
+
+private:
+    //! The base case for computing the linear index.
+    inline size_t linearIndex(unsigned int) const
+    {
+        return 0;
+    }
+
+    //! Compute the linear index of the indices starting at a dimension.
+    template<typename Int, typename... Ints>
+    inline size_t linearIndex(unsigned int dimension, Int index, Ints... indices) const
+    {
+#ifndef NDEBUG
+        if (static_cast<size_t>(index) >= m_shape[dimension])
+        {
+            std::ostringstream msg;
+            msg << "Attempted to access index " << index << " in dimension " << dimension
+                << ", which has size " << m_shape[dimension] << std::endl;
+            throw std::invalid_argument(msg.str());
+        }
+#endif
+        return static_cast<size_t>(index) * m_strides[dimension] + linearIndex(dimension + 1, indices...);
+    }
+
+    T* m_data;               //!< Pointer to the data of the array.
+    size_t m_shape[Rank];    //!< Shape of the array.
+    size_t m_strides[Rank];  //!< Distance between consecutive indices in each dimension.
+    size_t m_size;           //!< Size of the array.
+};
+
 //! Class to handle the storage of all arrays of numerical data used in freud.
 /*! The purpose of this class is to handle standard memory management, and to
  *  provide an abstraction around the implementation-specific choice of
@@ -33,9 +132,9 @@ namespace freud { namespace util {
  *  decoupled from it.
  *
  *  Performance notes:
- *      1. The variadic indexers may be a bottleneck if used in
- *         performance-critical code paths. In such cases, directly calling the
- *         overloaded signature using an std::vector is preferable.
+ *      1. The indexers check bounds on every access. In performance-critical
+ *         code paths, index into a ManagedArrayView obtained from view()
+ *         instead, which only checks bounds in debug builds.
  *      2. In situations where multiple identically shaped arrays are being
  *         indexed into, the index may be computed once using the getIndex
  *         function and reused to avoid recomputing it each time.
@@ -62,6 +161,29 @@ public:
      */
     ManagedArray(size_t size) : ManagedArray(std::vector<size_t> {size}) {}
 
+    //! Constructor wrapping data owned outside of freud without copying it.
+    /*! The ManagedArray never frees or writes to the wrapped data. Instead,
+     *  it keeps the owner of the data alive until no ManagedArray points to
+     *  the data any longer and then calls release(owner), which may happen
+     *  from any thread. Calls to prepare always allocate a new array rather
+     *  than reusing the wrapped data.
+     *
+     *  \param data Pointer to the data to wrap.
+     *  \param shape Shape of the data.
+     *  \param owner Handle to the owner of the data.
+     *  \param release Function releasing the owner of the data.
+     */
+    ManagedArray(T* data, std::vector<size_t> shape, void* owner, void (*release)(void*))
+        : m_data(std::make_shared<std::shared_ptr<T>>(data, [owner, release](T*) { release(owner); })),
+          m_shape(std::make_shared<std::vector<size_t>>(shape)), m_size(std::make_shared<size_t>(1)),
+          m_external(true)
+    {
+        for (size_t i = 0; i < shape.size(); ++i)
+        {
+            (*m_size) *= shape[i];
+        }
+    }
+
     //! Destructor (currently empty because data is managed by shared pointer).
     ~ManagedArray() {}
 
@@ -84,9 +206,9 @@ public:
      */
     void prepare(std::vector<size_t> new_shape, bool force = false)
     {
-        // If we resized, or if there are outstanding references, we create a new array. No matter what,
-        // reset.
-        if (force || (m_data.use_count() > 1) || (new_shape != shape()))
+        // If we resized, if there are outstanding references, or if the data is owned outside of freud, we
+        // create a new array. No matter what, reset.
+        if (force || m_external || (m_data.use_count() > 1) || (new_shape != shape()))
         {
             m_shape = std::make_shared<std::vector<size_t>>(new_shape);
 
@@ -98,10 +220,35 @@ public:
 
             m_data = std::shared_ptr<std::shared_ptr<T>>(
                 new std::shared_ptr<T>(new T[size()], std::default_delete<T[]>()));
+            m_external = false;
         }
         reset();
     }
 
+    //! Shrink a 1D array, keeping its first new_size elements.
+    /*! If there are other ManagedArrays pointing to the data or the data is
+     *  owned outside of freud, the kept elements are copied to a new array to
+     *  ensure that those array references are not invalidated and that data
+     *  owned outside of freud is never written to. Otherwise, the data is
+     *  kept in place and only the size of the array changes.
+     *
+     *  \param new_size Size of the array, which must not exceed the current size.
+     */
+    void shrink(size_t new_size)
+    {
+        if (m_external || m_data.use_count() > 1)
+        {
+            ManagedArray new_array(new_size);
+            std::copy(get(), get() + new_size, new_array.get());
+            *this = new_array;
+        }
+        else
+        {
+            m_shape = std::make_shared<std::vector<size_t>>(1, new_size);
+            m_size = std::make_shared<size_t>(new_size);
+        }
+    }
+
     //! Reset the contents of array to be 0.
     void reset()
     {
@@ -156,6 +303,12 @@ public:
         return *m_size;
     }
 
+    //! Get a view of the current array for fast indexing (see ManagedArrayView).
+    template<unsigned int Rank> ManagedArrayView<T, Rank> view() const
+    {
+        return ManagedArrayView<T, Rank>(get(), *m_shape);
+    }
+
     //! Get the shape of the current array.
     std::vector<size_t> shape() const
     {
@@ -164,31 +317,22 @@ public:
 
     //*************************************************************************
     // In order to support convenient indexing using arbitrary numbers of
-    // indices, we provide overloads of the indexing operator.  All calls
-    // eventually funnel through the simplest function interface, a std::vector
-    // of indices. However, the more convenient approach is enabled using
-    // variadic template arguments.
-    //
-    // Performance note: the variadic indexers can be expensive
-    // since they have to build up a std::vector through a sequence of
-    // (hopefully compiler optimized) function calls. In general, this is
-    // unimportant since performance critical code paths in freud do not
-    // involve large amounts of indexing into ManagedArrays. However, in cases
-    // where critical code paths do index into the array, it may be
-    // advantageous to directly call the function with a std::vector of indices
-    // and bypass the variadic indexers.
+    // indices, we provide overloads of the indexing operator. The variadic
+    // indexers compute the linear index directly from the shape, while the
+    // std::vector overloads support indices whose number is only known at
+    // runtime.
     //*************************************************************************
 
     //! Implementation of variadic indexing function.
     template<typename... Ints> inline T& operator()(Ints... indices)
     {
-        return (*this)(buildIndex(indices...));
+        return (*this)[buildIndex(0, 0, indices...)];
     }
 
     //! Constant implementation of variadic indexing function.
     template<typename... Ints> inline const T& operator()(Ints... indices) const
     {
-        return (*this)(buildIndex(indices...));
+        return (*this)[buildIndex(0, 0, indices...)];
     }
 
     //! Core function for multidimensional indexing.
@@ -329,30 +473,29 @@ public:
 
 private:
     //! The base case for building up the index.
-    /*! These argument building functions are templated on two types, one that
-     *  encapsulates the current object being operated on and the other being
-     *  the list of remaining arguments. Since users may provide both signed and
-     *  unsigned ints to the function, we perform the appropriate check on each
-     *  Int object. The second function is used for template recursion in
+    /*! These index building functions accumulate the linear index of the
+     *  indices in row-major order, one dimension at a time. Since users may
+     *  provide both signed and unsigned ints to the function, each index is
+     *  cast to size_t. The second function is used for template recursion in
      *  unwrapping the list of arguments.
      */
-    template<typename Int> inline static std::vector<size_t> buildIndex(Int index)
+    inline size_t buildIndex(size_t index, unsigned int) const
     {
-        return {static_cast<size_t>(index)};
+        return index;
     }
 
     //! The recursive case for building up the index (see above).
     template<typename Int, typename... Ints>
-    inline static std::vector<size_t> buildIndex(Int index, Ints... indices)
+    inline size_t buildIndex(size_t index, unsigned int dimension, Int next_index, Ints... indices) const
     {
-        std::vector<size_t> tmp = buildIndex(indices...);
-        tmp.insert(tmp.begin(), static_cast<size_t>(index));
-        return tmp;
+        return buildIndex(index * (*m_shape)[dimension] + static_cast<size_t>(next_index), dimension + 1,
+                          indices...);
     }
 
     std::shared_ptr<std::shared_ptr<T>> m_data;   //!< Pointer to array.
     std::shared_ptr<std::vector<size_t>> m_shape; //!< Shape of array.
     std::shared_ptr<size_t> m_size;               //!< Size of array.
+    bool m_external;                              //!< Whether the data is owned outside of freud.
 };
 
 }; }; // end namespace freud::util
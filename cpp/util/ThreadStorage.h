@@ -2,6 +2,7 @@
 #define THREADSTORAGE_H
 
 #include "ManagedArray.h"
+#include "utils.h"
 #include <tbb/tbb.h>
 #include <vector>
 
@@ -52,12 +53,14 @@ public:
     }
 
     //! Reset the contents of thread local arrays to be 0
+    /*! The thread local arrays are released rather than zeroed, and are
+     *  recreated with zeros when threads access them again. Threads that do
+     *  not access their array before the next reduction are thus skipped
+     *  when reducing.
+     */
     void reset()
     {
-        for (auto array = arrays.begin(); array != arrays.end(); ++array)
-        {
-            array->reset();
-        }
+        arrays.clear();
     }
 
     typedef typename tbb::enumerable_thread_specific<ManagedArray<T>>::const_iterator const_iterator;
@@ -89,6 +92,9 @@ public:
         return arrays.local();
     }
 
+    //! Add the thread local arrays into the result array.
+    /*! The reduction is blocked into tiles of the result (see reduceArrays).
+     */
     void reduceInto(ManagedArray<T>& result)
     {
         if (arrays.size() == 0)
@@ -100,16 +106,12 @@ public:
         }
         else
         {
-            // Reduce over arrays into the result array.
-            util::forLoopWrapper(0, result.size(), [=, &result](size_t begin, size_t end) {
-                for (size_t i = begin; i < end; ++i)
-                {
-                    for (auto arr = arrays.begin(); arr != arrays.end(); ++arr)
-                    {
-                        result[i] += (*arr)[i];
-                    }
-                }
-            });
+            std::vector<const T*> local_arrays;
+            for (auto array = arrays.begin(); array != arrays.end(); ++array)
+            {
+                local_arrays.push_back(array->get());
+            }
+            reduceArrays(result.get(), local_arrays, result.size());
         }
     }
 
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cmath>
 #include <tbb/tbb.h>
+#include <vector>
 
 #if defined _WIN32
 #undef min // std::min clashes with a Windows header
@@ -49,6 +50,42 @@ inline void forLoopWrapper(size_t begin, size_t end, const Body& body, bool para
     }
 }
 
+//! Number of elements of the output summed at once by reduceArrays.
+/*! A tile of the output stays in the L1 cache while the corresponding tiles of
+ *  all input arrays are added to it.
+ */
+const size_t REDUCTION_TILE_SIZE = 1024;
+
+//! Add a set of arrays elementwise into an output array in parallel.
+/*! The output is split into tiles, and each tile is reduced by adding the same
+ *  tile of each input array to it in turn. All arrays are therefore read
+ *  contiguously rather than striding across the inputs for every element,
+ *  and the addition of two tiles is a plain loop over raw pointers that
+ *  compilers vectorize.
+ *
+ *  \param result The output array, to which the inputs are added.
+ *  \param arrays Pointers to the input arrays.
+ *  \param size The number of elements of the output and of each input.
+ */
+template<typename T> void reduceArrays(T* result, const std::vector<const T*>& arrays, size_t size)
+{
+    forLoopWrapper(0, size, [&](size_t begin, size_t end) {
+        for (size_t tile_begin = begin; tile_begin < end; tile_begin += REDUCTION_TILE_SIZE)
+        {
+            const size_t tile_size = std::min(end - tile_begin, REDUCTION_TILE_SIZE);
+            T* tile = result + tile_begin;
+            for (const T* array : arrays)
+            {
+                const T* array_tile = array + tile_begin;
+                for (size_t i = 0; i < tile_size; ++i)
+                {
+                    tile[i] += array_tile[i];
+                }
+            }
+        }
+    });
+}
+
 }; }; // namespace freud::util
 
 #endif
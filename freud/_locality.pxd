@@ -34,6 +34,7 @@ cdef extern from "NeighborQuery.h" namespace "freud::locality":
         float r_guess
         float scale
         bool exclude_ii
+        bool unique_pairs
 
     cdef cppclass NeighborQuery:
         NeighborQuery() except +
@@ -72,12 +73,18 @@ cdef extern from "NeighborList.h" namespace "freud::locality":
         NeighborList(unsigned int, const unsigned int*, unsigned int,
                      const unsigned int*, unsigned int, const float*,
                      const float*) except +
-
-        freud.util.ManagedArray[unsigned int] &getNeighbors()
+        NeighborList(const unsigned int*, unsigned int,
+                     const freud.util.ManagedArray[unsigned int] &,
+                     unsigned int,
+                     const freud.util.ManagedArray[float] &,
+                     const freud.util.ManagedArray[float] &) except +
+
+        const freud.util.ManagedArray[unsigned int] &getNeighbors() const
+        freud.util.ManagedArray[unsigned int] &getPointIndices()
         freud.util.ManagedArray[float] &getDistances()
         freud.util.ManagedArray[float] &getWeights()
-        freud.util.ManagedArray[float] &getSegments()
-        freud.util.ManagedArray[float] &getCounts()
+        freud.util.ManagedArray[unsigned int] &getSegments()
+        const freud.util.ManagedArray[unsigned int] &getCounts() const
 
         unsigned int getNumBonds() const
         unsigned int getNumPoints() const
@@ -85,6 +92,7 @@ cdef extern from "NeighborList.h" namespace "freud::locality":
         void setNumBonds(unsigned int, unsigned int, unsigned int)
         unsigned int filter(const bool*) except +
         unsigned int filter_r(float, float) except +
+        void mirror() except +
 
         unsigned int find_first_index(unsigned int)
 
@@ -100,6 +108,7 @@ cdef extern from "LinkCell.h" namespace "freud::locality":
                  unsigned int,
                  float) except +
         float getCellWidth() const
+        void update(const vec3[float]*, unsigned int) except +
 
 cdef extern from "AABBQuery.h" namespace "freud::locality":
     cdef cppclass AABBQuery(NeighborQuery):
@@ -107,6 +116,10 @@ cdef extern from "AABBQuery.h" namespace "freud::locality":
         AABBQuery(const freud._box.Box,
                   const vec3[float]*,
                   unsigned int) except +
+        void update(const vec3[float]*, unsigned int) except +
+        float getRebuildThreshold() const
+        void setRebuildThreshold(float) except +
+        unsigned int getNumBuilds() const
 
 cdef extern from "BondHistogramCompute.h" namespace "freud::locality":
     cdef cppclass BondHistogramCompute:
@@ -119,6 +132,8 @@ cdef extern from "BondHistogramCompute.h" namespace "freud::locality":
         vector[vector[float]] getBinCenters() const
         vector[pair[float, float]] getBounds() const
         vector[size_t] getAxisSizes() const
+        void setSharedHistogram(bool)
+        bool isSharedHistogram() const
 
 cdef extern from "PeriodicBuffer.h" namespace "freud::locality":
     cdef cppclass PeriodicBuffer:
@@ -132,10 +147,26 @@ cdef extern from "PeriodicBuffer.h" namespace "freud::locality":
         vector[vec3[float]] getBufferPoints() const
         vector[uint] getBufferIds() const
 
+cdef extern from "VerletList.h" namespace "freud::locality":
+    cdef cppclass VerletList:
+        VerletList(float) except +
+        void compute(
+            const NeighborQuery*,
+            const vec3[float]*,
+            unsigned int,
+            QueryArgs) except +
+        void reset()
+        float getSkin() const
+        unsigned int getNumBuilds() const
+        shared_ptr[NeighborList] getNeighborList() const
+
 cdef extern from "Voronoi.h" namespace "freud::locality":
     cdef cppclass Voronoi:
-        Voronoi()
+        Voronoi(bool)
         void compute(const NeighborQuery*) nogil except +
-        vector[vector[vec3[double]]] getPolytopes() const
+        bool isNeighborsOnly() const
+        const freud.util.ManagedArray[double] &getPolytopeVertices() const
+        const freud.util.ManagedArray[unsigned int] \
+            &getPolytopeSegments() const
         const freud.util.ManagedArray[double] &getVolumes() const
         shared_ptr[NeighborList] getNeighborList() const
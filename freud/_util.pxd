@@ -25,6 +25,7 @@ cdef extern from "ManagedArray.h" namespace "freud::util":
     cdef cppclass ManagedArray[T]:
         ManagedArray()
         ManagedArray(const ManagedArray[T] &)
+        ManagedArray(T*, vector[size_t], void*, void (*)(void*))
         T *get()
         size_t size() const
         vector[size_t] shape() const
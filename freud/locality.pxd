@@ -74,6 +74,10 @@ cdef class _SpatialHistogram1D(_SpatialHistogram):
 cdef class PeriodicBuffer(_Compute):
     cdef freud._locality.PeriodicBuffer * thisptr
 
+cdef class VerletList(_PairCompute):
+    cdef freud._locality.VerletList * thisptr
+    cdef NeighborList _nlist
+
 cdef class Voronoi(_Compute):
     cdef freud._locality.Voronoi * thisptr
     cdef NeighborList _nlist
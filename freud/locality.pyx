@@ -13,7 +13,8 @@ import numpy as np
 from freud.errors import NO_DEFAULT_QUERY_ARGS_MESSAGE
 
 from libcpp cimport bool as cbool
-from freud.util cimport vec3
+from freud.util cimport vec3, uint, ManagedArray
+from cpython.ref cimport Py_INCREF, Py_DECREF
 from cython.operator cimport dereference
 from libcpp.memory cimport shared_ptr
 from libcpp.vector cimport vector
@@ -30,6 +31,13 @@ logger = logging.getLogger(__name__)
 # _always_ do that, or you will have segfaults
 np.import_array()
 
+
+cdef void _release_array(void *array) noexcept with gil:
+    # Release the reference to a NumPy array held by the C++ ManagedArrays
+    # wrapping its data. This may be called from any thread.
+    Py_DECREF(<object> array)
+
+
 cdef class _QueryArgs:
     R"""Container for query arguments.
 
@@ -42,7 +50,7 @@ cdef class _QueryArgs:
 
     def __cinit__(self, mode=None, r_min=None, r_max=None, r_guess=None,
                   num_neighbors=None, exclude_ii=None,
-                  scale=None, **kwargs):
+                  scale=None, unique_pairs=None, **kwargs):
         if type(self) == _QueryArgs:
             self.thisptr = new freud._locality.QueryArgs()
             self.mode = mode
@@ -58,6 +66,8 @@ cdef class _QueryArgs:
                 self.exclude_ii = exclude_ii
             if scale is not None:
                 self.scale = scale
+            if unique_pairs is not None:
+                self.unique_pairs = unique_pairs
             if len(kwargs):
                 err_str = ", ".join(
                     "{} = {}".format(k, v) for k, v in kwargs.items())
@@ -154,15 +164,24 @@ cdef class _QueryArgs:
     def scale(self, value):
         self.thisptr.scale = value
 
+    @property
+    def unique_pairs(self):
+        return self.thisptr.unique_pairs
+
+    @unique_pairs.setter
+    def unique_pairs(self, value):
+        self.thisptr.unique_pairs = value
+
     def __repr__(self):
         return ("freud.locality.{cls}(mode={mode}, r_max={r_max}, "
                 "num_neighbors={num_neighbors}, exclude_ii={exclude_ii}, "
-                "scale={scale})").format(
+                "scale={scale}, unique_pairs={unique_pairs})").format(
                     cls=type(self).__name__,
                     mode=self.mode, r_max=self.r_max,
                     num_neighbors=self.num_neighbors,
                     exclude_ii=self.exclude_ii,
-                    scale=self.scale)
+                    scale=self.scale,
+                    unique_pairs=self.unique_pairs)
 
     def __str__(self):
         return repr(self)
@@ -438,10 +457,12 @@ cdef class NeighborList:
 
     For efficiency, all bonds must be sorted by the query point index, from
     least to greatest. Bonds have an query point index :math:`i` and a point
-    index :math:`j`. The first bond index corresponding to a given query point
-    can be found in :math:`\log(N_{bonds})` time using
-    :meth:`find_first_index`, because bonds are ordered by the query point
-    index.
+    index :math:`j`. The bonds are stored in compressed sparse row form: only
+    the first bond index of each query point (see :attr:`segments`) and the
+    point index of each bond are stored, so the first bond index
+    corresponding to a given query point can be found in constant time using
+    :meth:`find_first_index`. The array of index pairs is only built when
+    the NeighborList is indexed or :attr:`query_point_indices` is accessed.
 
     .. note::
 
@@ -475,6 +496,12 @@ cdef class NeighborList:
                     point_indices, distances, weights=None):
         R"""Create a NeighborList from a set of bond information arrays.
 
+        The point indices, distances, and weights are used without copying
+        them if they are already contiguous arrays of the right data type
+        (:class:`numpy.uint32` for indices and :class:`numpy.float32`
+        otherwise). In that case, the NeighborList keeps references to these
+        arrays, which must not be modified while the NeighborList exists.
+
         Args:
             num_query_points (int):
                 Number of query points (corresponding to
@@ -516,11 +543,32 @@ cdef class NeighborList:
         cdef unsigned int l_num_query_points = num_query_points
         cdef unsigned int l_num_points = num_points
 
+        cdef vector[size_t] l_shape = [l_num_bonds]
+
+        # The bond arrays are wrapped rather than copied, and each wrapping
+        # ManagedArray keeps a reference to its array for as long as the
+        # data is in use.
+        Py_INCREF(point_indices)
+        Py_INCREF(distances)
+        Py_INCREF(weights)
+        cdef freud._locality.NeighborList * l_nlist
+        l_nlist = new freud._locality.NeighborList(
+            &l_query_point_indices[0], l_num_query_points,
+            ManagedArray[uint](
+                <uint*> &l_point_indices[0], l_shape,
+                <void*> point_indices, _release_array),
+            l_num_points,
+            ManagedArray[float](
+                <float*> &l_distances[0], l_shape,
+                <void*> distances, _release_array),
+            ManagedArray[float](
+                <float*> &l_weights[0], l_shape,
+                <void*> weights, _release_array))
+
         cdef NeighborList result
         result = cls()
-        result.thisptr = new freud._locality.NeighborList(
-            l_num_bonds, &l_query_point_indices[0], l_num_query_points,
-            &l_point_indices[0], l_num_points, &l_distances[0], &l_weights[0])
+        del result.thisptr
+        result.thisptr = l_nlist
 
         return result
 
@@ -583,7 +631,9 @@ cdef class NeighborList:
         bond. This array is read-only to prevent breakage of
         :meth:`~.find_first_index()`. Equivalent to indexing with :code:`[:,
         1]`."""
-        return self[:, 1]
+        return freud.util.make_managed_numpy_array(
+            &self.thisptr.getPointIndices(),
+            freud.util.arr_type_t.UNSIGNED_INT)
 
     @property
     def weights(self):
@@ -605,9 +655,11 @@ cdef class NeighborList:
     def segments(self):
         """(:math:`N_{query\\_points}`) :class:`np.ndarray`: A segment array
         indicating the first bond index for each query point."""
+        # The stored segments end with the number of bonds.
         return freud.util.make_managed_numpy_array(
             &self.thisptr.getSegments(),
-            freud.util.arr_type_t.UNSIGNED_INT)
+            freud.util.arr_type_t.UNSIGNED_INT)[
+                :self.thisptr.getNumQueryPoints()]
 
     @property
     def neighbor_counts(self):
@@ -664,6 +716,18 @@ cdef class NeighborList:
         self.thisptr.filter_r(r_max, r_min)
         return self
 
+    def mirror(self):
+        R"""Adds the reverse of every bond and sorts the bonds by query point
+        and point index.
+
+        This turns a neighbor list containing each pair of points only once,
+        e.g. one found with the :code:`unique_pairs` query argument, into one
+        containing both directions of every bond. The query points and points
+        of the neighbor list must be the same.
+        """
+        self.thisptr.mirror()
+        return self
+
 
 cdef NeighborList _nlist_from_cnlist(freud._locality.NeighborList *c_nlist):
     """Create a Python NeighborList object that points to an existing C++
@@ -807,6 +871,46 @@ cdef class AABBQuery(NeighborQuery):
         if type(self) is AABBQuery:
             del self.thisptr
 
+    @property
+    def rebuild_threshold(self):
+        """float: Ratio of the total surface area of the refit tree nodes to
+        that of the last built tree above which :meth:`~.update` rebuilds
+        the tree."""
+        return self.thisptr.getRebuildThreshold()
+
+    @rebuild_threshold.setter
+    def rebuild_threshold(self, value):
+        self.thisptr.setRebuildThreshold(value)
+
+    @property
+    def num_builds(self):
+        """int: Number of times the tree has been built."""
+        return self.thisptr.getNumBuilds()
+
+    def update(self, points):
+        R"""Update the positions of the points in the tree.
+
+        The bounding boxes of the existing tree are refit to the new
+        positions, which is much faster than constructing a new
+        :class:`~.AABBQuery` when the points moved only slightly, e.g. between
+        frames of a simulation. The tree is rebuilt once refitting has
+        degraded it past the :attr:`~.rebuild_threshold`, or when the number
+        of points changed.
+
+        Args:
+            points ((:math:`N`, 3) :class:`numpy.ndarray`):
+                The new point positions.
+        """
+        cdef const float[:, ::1] l_points
+        new_points = freud.util._convert_array(
+            points, shape=(None, 3)).copy()
+        l_points = new_points
+        self.thisptr.update(<vec3[float]*> &l_points[0, 0],
+                            new_points.shape[0])
+        # Only keep the new points once the C++ object points to them.
+        self.points = new_points
+        return self
+
 
 cdef class LinkCell(NeighborQuery):
     R"""Supports efficiently finding all points in a set within a certain
@@ -844,6 +948,28 @@ cdef class LinkCell(NeighborQuery):
         """float: Cell width."""
         return self.thisptr.getCellWidth()
 
+    def update(self, points):
+        R"""Update the positions of the points in the cell list.
+
+        The box and cell width are kept, so only points that moved to a
+        different cell need to be moved between cells. This is much faster
+        than constructing a new :class:`~.LinkCell` when the points moved only
+        slightly, e.g. between frames of a simulation.
+
+        Args:
+            points ((:math:`N`, 3) :class:`numpy.ndarray`):
+                The new point positions.
+        """
+        cdef const float[:, ::1] l_points
+        new_points = freud.util._convert_array(
+            points, shape=(None, 3)).copy()
+        l_points = new_points
+        self.thisptr.update(<vec3[float]*> &l_points[0, 0],
+                            new_points.shape[0])
+        # Only keep the new points once the C++ object points to them.
+        self.points = new_points
+        return self
+
 
 cdef class _PairCompute(_Compute):
     R"""Parent class for all compute classes in freud that depend on finding
@@ -981,6 +1107,23 @@ cdef class _SpatialHistogram(_PairCompute):
         histogram"""
         return list(self.histptr.getAxisSizes())
 
+    @property
+    def shared_histogram(self):
+        """bool: Whether all threads count bonds in a single histogram with
+        atomic increments instead of in a copy of the histogram per thread
+        (default: :code:`False`). Sharing the bin counts keeps their memory
+        use independent of the number of threads, which is useful for
+        histograms with many bins such as fine 3D grids. The bin counts are
+        the same either way. Only the bin counts are shared: other per-thread
+        accumulators, such as the correlation values of
+        :class:`freud.density.CorrelationFunction`, are still copied per
+        thread."""
+        return self.histptr.isSharedHistogram()
+
+    @shared_histogram.setter
+    def shared_histogram(self, value):
+        self.histptr.setSharedHistogram(value)
+
     def _reset(self):
         # Resets the values of RDF in memory.
         self.histptr.reset()
@@ -1098,6 +1241,104 @@ cdef class PeriodicBuffer(_Compute):
         return repr(self)
 
 
+cdef class VerletList(_PairCompute):
+    R"""Reuses a neighbor list across frames until points have moved too far.
+
+    In trajectory analysis, points usually move very little between
+    consecutive frames. This class finds all bonds within a distance of
+    :code:`r_max + skin` and reuses them in subsequent calls to
+    :meth:`~.compute` as long as no point has moved by more than half of the
+    skin (more generally, as long as the largest displacement of the points
+    plus the largest displacement of the query points is smaller than the
+    skin). The neighbor list is then obtained by recomputing the distances of
+    the stored bonds and removing those outside of the query range, which is
+    much cheaper than finding neighbors from scratch.
+
+    The stored bonds are also discarded if the box, the number of points or
+    the query arguments change. Only ball queries are supported.
+
+    Args:
+        skin (float):
+            Distance beyond :code:`r_max` within which bonds are stored.
+    """
+
+    def __cinit__(self, float skin):
+        self.thisptr = new freud._locality.VerletList(skin)
+        self._nlist = NeighborList()
+
+    def __dealloc__(self):
+        del self.thisptr
+
+    def compute(self, system, query_args, query_points=None):
+        R"""Compute the neighbor list, reusing previously found bonds if
+        possible.
+
+        Args:
+            system:
+                Any object that is a valid argument to
+                :class:`freud.locality.NeighborQuery.from_system`.
+            query_args (dict):
+                Query arguments of a ball query, e.g. :code:`dict(r_max=2)`.
+                If :code:`exclude_ii` is not provided, it is set to
+                :code:`True` if :code:`query_points` is :code:`None`.
+            query_points ((:math:`N_{query\_points}`, 3) :class:`numpy.ndarray`, optional):
+                Query points used to calculate the neighbor list. Uses the
+                system's points if :code:`None` (Default value =
+                :code:`None`).
+        """  # noqa E501
+        if type(query_args) != dict:
+            raise ValueError('The query arguments must be a dict.')
+
+        cdef:
+            NeighborQuery nq
+            NeighborList nlist
+            _QueryArgs qargs
+            const float[:, ::1] l_query_points
+            unsigned int num_query_points
+
+        nq, nlist, qargs, l_query_points, num_query_points = \
+            self._preprocess_arguments(system, query_points, query_args)
+
+        self.thisptr.compute(
+            nq.get_ptr(), <vec3[float]*> &l_query_points[0, 0],
+            num_query_points, dereference(qargs.thisptr))
+        return self
+
+    def reset(self):
+        R"""Discard the stored bonds so that the next call to
+        :meth:`~.compute` finds them again."""
+        self.thisptr.reset()
+
+    @property
+    def skin(self):
+        """float: Distance beyond :code:`r_max` within which bonds are
+        stored."""
+        return self.thisptr.getSkin()
+
+    @property
+    def num_builds(self):
+        """int: Number of times the stored bonds have been found from
+        scratch."""
+        return self.thisptr.getNumBuilds()
+
+    @_Compute._computed_property
+    def nlist(self):
+        """:class:`~.locality.NeighborList`: A copy of the neighbor list of
+        the last call to :meth:`~.compute`. The stored bonds are updated in
+        place by later calls, so the returned list does not change with
+        them."""
+        self._nlist = _nlist_from_cnlist(
+            self.thisptr.getNeighborList().get()).copy()
+        return self._nlist
+
+    def __repr__(self):
+        return "freud.locality.{cls}(skin={skin})".format(
+            cls=type(self).__name__, skin=self.skin)
+
+    def __str__(self):
+        return repr(self)
+
+
 cdef class Voronoi(_Compute):
     R"""Computes Voronoi diagrams using voro++.
 
@@ -1109,12 +1350,20 @@ cdef class Voronoi(_Compute):
     input point. A ridge is defined as a boundary between cells, which contains
     points equally close to two or more input points.
 
-    The voro++ library :cite:`Rycroft2009` is used for fast computations of the
-    Voronoi diagram.
+    The voro++ library :cite:`Rycroft2009` is used for fast computations of
+    3D Voronoi diagrams. In 2D systems, the polygonal cells are computed
+    directly in the plane.
+
+    Args:
+        neighbors_only (bool, optional):
+            Only compute the neighbor list and cell volumes, skipping the
+            polytope vertices. This is faster when only the neighbors are
+            needed, but :attr:`polytopes` and :meth:`plot` are unavailable.
+            (Default value = :code:`False`)
     """
 
-    def __cinit__(self):
-        self.thisptr = new freud._locality.Voronoi()
+    def __cinit__(self, neighbors_only=False):
+        self.thisptr = new freud._locality.Voronoi(neighbors_only)
         self._nlist = NeighborList()
 
     def __dealloc__(self):
@@ -1137,24 +1386,22 @@ cdef class Voronoi(_Compute):
     def polytopes(self):
         """list[:class:`numpy.ndarray`]: A list of :class:`numpy.ndarray`
         defining Voronoi polytope vertices for each cell."""
-        polytopes = []
-        cdef vector[vector[vec3[double]]] raw_polytopes = \
-            self.thisptr.getPolytopes()
-        cdef size_t i
-        cdef size_t j
-        cdef size_t num_verts
-        cdef vector[vec3[double]] raw_vertices
-        cdef double[:, ::1] polytope_vertices
-        for i in range(raw_polytopes.size()):
-            raw_vertices = raw_polytopes[i]
-            num_verts = raw_vertices.size()
-            polytope_vertices = np.empty((num_verts, 3), dtype=np.float64)
-            for j in range(num_verts):
-                polytope_vertices[j, 0] = raw_vertices[j].x
-                polytope_vertices[j, 1] = raw_vertices[j].y
-                polytope_vertices[j, 2] = raw_vertices[j].z
-            polytopes.append(np.asarray(polytope_vertices))
-        return polytopes
+        if self.neighbors_only:
+            raise AttributeError(
+                "Polytopes are not computed when neighbors_only is True.")
+        vertices = freud.util.make_managed_numpy_array(
+            &self.thisptr.getPolytopeVertices(),
+            freud.util.arr_type_t.DOUBLE)
+        segments = freud.util.make_managed_numpy_array(
+            &self.thisptr.getPolytopeSegments(),
+            freud.util.arr_type_t.UNSIGNED_INT)
+        return [vertices[segments[i]:segments[i + 1]]
+                for i in range(len(segments) - 1)]
+
+    @property
+    def neighbors_only(self):
+        """bool: Whether only the neighbors and volumes are computed."""
+        return self.thisptr.isNeighborsOnly()
 
     @_Compute._computed_property
     def volumes(self):
@@ -1187,8 +1434,8 @@ cdef class Voronoi(_Compute):
         return self._nlist
 
     def __repr__(self):
-        return "freud.locality.{cls}()".format(
-            cls=type(self).__name__)
+        return "freud.locality.{cls}(neighbors_only={neighbors_only})".format(
+            cls=type(self).__name__, neighbors_only=self.neighbors_only)
 
     def __str__(self):
         return repr(self)
@@ -109,6 +109,18 @@ class TestNeighborList(unittest.TestCase):
         # should be able to further filter
         self.nlist.filter_r(2.5)
 
+    def test_filter_keeps_views(self):
+        # Arrays obtained before filtering are not modified by the filter
+        point_indices = self.nlist.point_indices
+        old_point_indices = np.copy(point_indices)
+        distances = self.nlist.distances
+        old_distances = np.copy(distances)
+        kept_neighbors = self.nlist[distances < 2.5]
+        self.nlist.filter_r(2.5)
+        npt.assert_equal(point_indices, old_point_indices)
+        npt.assert_equal(distances, old_distances)
+        npt.assert_equal(kept_neighbors, self.nlist[:])
+
     def test_find_first_index(self):
         nlist = self.nlist
         for (idx, i) in enumerate(nlist.query_point_indices):
@@ -120,6 +132,24 @@ class TestNeighborList(unittest.TestCase):
             np.allclose(np.add.reduceat(ones, self.nlist.segments), 6))
         self.assertTrue(np.allclose(self.nlist.neighbor_counts, 6))
 
+    def test_segments_without_bonds(self):
+        # Query points without bonds have empty segments
+        query_point_indices = [0, 0, 2, 2, 2]
+        point_indices = [1, 2, 0, 1, 3]
+        distances = np.ones(len(query_point_indices))
+        nlist = freud.locality.NeighborList.from_arrays(
+            4, 4, query_point_indices, point_indices, distances)
+        npt.assert_equal(nlist.segments, [0, 2, 2, 5])
+        npt.assert_equal(nlist.neighbor_counts, [2, 0, 3, 0])
+        npt.assert_equal(
+            [nlist.find_first_index(i) for i in range(5)], [0, 2, 2, 5, 5])
+        npt.assert_equal(nlist.query_point_indices, query_point_indices)
+        npt.assert_equal(nlist.point_indices, point_indices)
+
+        nlist.filter(np.array([True, False, False, True, True]))
+        npt.assert_equal(nlist.segments, [0, 1, 1, 3])
+        npt.assert_equal(nlist[:], [[0, 1], [2, 1], [2, 3]])
+
     def test_from_arrays(self):
         query_point_indices = [0, 0, 1, 2, 3]
         point_indices = [1, 2, 3, 0, 0]
@@ -180,6 +210,59 @@ class TestNeighborList(unittest.TestCase):
             nlist = freud.locality.NeighborList.from_arrays(
                 4, 4, query_point_indices, point_indices, distances, weights)
 
+    def test_from_arrays_no_copy(self):
+        query_point_indices = np.array([0, 0, 1, 2, 3], dtype=np.uint32)
+        point_indices = np.array([1, 2, 3, 0, 0], dtype=np.uint32)
+        distances = np.linspace(1, 2, 5, dtype=np.float32)
+        weights = np.linspace(2, 3, 5, dtype=np.float32)
+        nlist = freud.locality.NeighborList.from_arrays(
+            4, 4, query_point_indices, point_indices, distances, weights)
+
+        # Contiguous arrays of the right types are used without copying
+        self.assertTrue(np.shares_memory(nlist.point_indices, point_indices))
+        self.assertTrue(np.shares_memory(nlist.distances, distances))
+        self.assertTrue(np.shares_memory(nlist.weights, weights))
+
+        # The NeighborList keeps the arrays alive
+        del point_indices, distances, weights
+        npt.assert_equal(nlist.point_indices, [1, 2, 3, 0, 0])
+        npt.assert_allclose(nlist.distances, np.linspace(1, 2, 5))
+        npt.assert_allclose(nlist.weights, np.linspace(2, 3, 5))
+
+        # Filtering does not modify the wrapped arrays
+        point_indices = nlist.point_indices
+        nlist.filter_r(1.6)
+        npt.assert_equal(nlist.point_indices, [1, 2, 3])
+        npt.assert_equal(point_indices, [1, 2, 3, 0, 0])
+
+    def test_from_arrays_unchanged(self):
+        # Modifying a NeighborList never writes to the wrapped arrays
+        query_point_indices = np.array([0, 0, 1], dtype=np.uint32)
+        point_indices = np.array([0, 0, 1], dtype=np.uint32)
+        distances = np.array([2, 1, 3], dtype=np.float32)
+        weights = np.array([4, 4, 6], dtype=np.float32)
+        sources = (query_point_indices, point_indices, distances, weights)
+        copies = [np.copy(a) for a in sources]
+
+        nlist = freud.locality.NeighborList.from_arrays(2, 2, *sources)
+        nlist.mirror()
+        for source, copy in zip(sources, copies):
+            npt.assert_equal(source, copy)
+
+        nlist = freud.locality.NeighborList.from_arrays(2, 2, *sources)
+        nlist.filter(np.array([True, False, True]))
+        for source, copy in zip(sources, copies):
+            npt.assert_equal(source, copy)
+
+        # Read-only arrays can be wrapped and modified without errors
+        for source in sources:
+            source.flags.writeable = False
+        nlist = freud.locality.NeighborList.from_arrays(2, 2, *sources)
+        nlist.mirror()
+        nlist.filter_r(2.5)
+        for source, copy in zip(sources, copies):
+            npt.assert_equal(source, copy)
+
     def test_indexing_empty(self):
         # Ensure that empty NeighborLists have the right shape
         nlist = self.nq.query(np.empty((0, 3)),
@@ -341,6 +341,39 @@ class NeighborQueryTest(object):
 
         self.assertEqual(ij1, ij2)
 
+    def test_unique_pairs(self):
+        L, r_max, N = (10, 2.01, 1024)
+
+        box, points = freud.data.make_random_system(L, N, seed=0)
+        nq = self.build_query_object(box, points, r_max)
+        query_args = dict(mode='ball', r_max=r_max, exclude_ii=True)
+        nlist = nq.query(points, query_args).toNeighborList()
+        unique_nlist = nq.query(
+            points, dict(unique_pairs=True, **query_args)).toNeighborList()
+
+        # Each pair must be found exactly once in either direction.
+        pairs = {(min(i, j), max(i, j)) for i, j in unique_nlist}
+        self.assertEqual(len(pairs), len(unique_nlist))
+        self.assertEqual(2*len(unique_nlist), len(nlist))
+
+        # Mirroring must recover the full sorted neighbor list.
+        unique_nlist.mirror()
+        npt.assert_equal(unique_nlist[:], nlist[:])
+        npt.assert_allclose(unique_nlist.distances, nlist.distances,
+                            rtol=1e-5, atol=1e-6)
+
+    def test_unique_pairs_invalid(self):
+        L, r_max, N = (10, 2.01, 100)
+
+        box, points = freud.data.make_random_system(L, N, seed=0)
+        nq = self.build_query_object(box, points, r_max)
+        with self.assertRaises(ValueError):
+            nq.query(points[:N//2],
+                     dict(r_max=r_max, unique_pairs=True)).toNeighborList()
+        with self.assertRaises(RuntimeError):
+            nq.query(points,
+                     dict(num_neighbors=4, unique_pairs=True)).toNeighborList()
+
     def test_exhaustive_search(self):
         L, r_max, N = (10, 1.999, 32)
 
@@ -619,6 +652,65 @@ class TestNeighborQueryAABB(NeighborQueryTest, unittest.TestCase):
                 else:
                     original_nlist = nlist
 
+    def test_query_nearest_clusters(self):
+        """Check nearest neighbors in a system with very uneven density."""
+        np.random.seed(0)
+        L = 20
+        box = freud.box.Box.cube(L)
+
+        # Dense clusters, one of them across the periodic boundary, and a few
+        # isolated points whose nearest neighbors are far away.
+        centers = np.array([[0, 0, 0], [5, -5, 2], [L/2, 3, -4]])
+        positions = np.concatenate(
+            [c + 0.2*np.random.randn(50, 3) for c in centers] +
+            [np.random.uniform(-L/2, L/2, (10, 3))]).astype(np.float32)
+        positions = box.wrap(positions)
+        nq = self.build_query_object(box, positions, L/10)
+
+        k = 8
+        nlist = nq.query(
+            positions, dict(num_neighbors=k, exclude_ii=True)).toNeighborList()
+        self.assertEqual(len(nlist), k * len(positions))
+        for i, point in enumerate(positions):
+            distances = np.linalg.norm(
+                box.wrap(positions - point), axis=-1)
+            distances[i] = np.inf
+            npt.assert_allclose(
+                np.sort(nlist.distances[nlist.query_point_indices == i]),
+                np.sort(distances)[:k], rtol=1e-5, atol=1e-6)
+
+    def test_update(self):
+        """Check that refitting the tree matches a new AABBQuery."""
+        N = 500
+        L = 10
+        r_max = 1
+        box, points = freud.data.make_random_system(L, N, seed=0)
+        # Points wrapping through the box boundaries stretch the tree nodes,
+        # so keep them away from the boundaries for the small moves.
+        points *= 0.9
+        aq = freud.locality.AABBQuery(box, points)
+        np.random.seed(0)
+        for scale, num_builds in [(0.01, 1), (0.01, 1), (L, 2)]:
+            points = box.wrap(
+                points + scale*np.random.uniform(-1, 1, points.shape))
+            aq.update(points)
+            self.assertEqual(aq.num_builds, num_builds)
+            npt.assert_allclose(aq.points, points)
+            for query_args in [dict(r_max=r_max, exclude_ii=True),
+                               dict(num_neighbors=6, exclude_ii=True)]:
+                nlist1 = aq.query(points, query_args).toNeighborList()
+                nlist2 = freud.locality.AABBQuery(box, points).query(
+                    points, query_args).toNeighborList()
+                self.assertTrue(nlist_equal(nlist1, nlist2))
+
+    def test_rebuild_threshold(self):
+        box, points = freud.data.make_random_system(10, 100, seed=0)
+        aq = freud.locality.AABBQuery(box, points)
+        aq.rebuild_threshold = 2
+        self.assertEqual(aq.rebuild_threshold, 2)
+        with self.assertRaises(ValueError):
+            aq.rebuild_threshold = 0.5
+
 
 class TestNeighborQueryLinkCell(NeighborQueryTest, unittest.TestCase):
     @classmethod
@@ -639,6 +731,25 @@ class TestNeighborQueryLinkCell(NeighborQueryTest, unittest.TestCase):
                                        exclude_ii=True)).toNeighborList()
         self.assertTrue(nlist_equal(nlist1, nlist2))
 
+    def test_update(self):
+        """Check that updating the points matches a new LinkCell."""
+        N = 500
+        L = 10
+        r_max = 1
+        box, points = freud.data.make_random_system(L, N, seed=0)
+        lc = freud.locality.LinkCell(box, points, 1.0)
+        np.random.seed(0)
+        for scale in [0.01, 0.5, L]:
+            points = box.wrap(
+                points + scale*np.random.uniform(-1, 1, points.shape))
+            lc.update(points)
+            npt.assert_allclose(lc.points, points)
+            nlist1 = lc.query(points, dict(
+                r_max=r_max, exclude_ii=True)).toNeighborList()
+            nlist2 = freud.locality.LinkCell(box, points, 1.0).query(
+                points, dict(r_max=r_max, exclude_ii=True)).toNeighborList()
+            npt.assert_equal(nlist1[:], nlist2[:])
+
     def test_default_cell_width(self):
         """Check that using a default cell width works."""
         N = 500
@@ -0,0 +1,85 @@
+import numpy as np
+import numpy.testing as npt
+import freud
+import unittest
+
+
+class TestVerletList(unittest.TestCase):
+    def setUp(self):
+        self.L = 10
+        self.N = 500
+        self.r_max = 1.5
+        self.skin = 0.4
+        self.box, self.points = freud.data.make_random_system(
+            self.L, self.N, seed=0)
+
+    def check_nlist(self, vl, points, query_args):
+        aq = freud.locality.AABBQuery(self.box, points)
+        nlist = aq.query(points, query_args).toNeighborList()
+        npt.assert_equal(vl.nlist[:], nlist[:])
+        npt.assert_allclose(vl.nlist.distances, nlist.distances,
+                            rtol=1e-5, atol=1e-6)
+
+    def test_reuse(self):
+        np.random.seed(0)
+        vl = freud.locality.VerletList(self.skin)
+        query_args = dict(r_max=self.r_max, exclude_ii=True)
+        points = self.points.copy()
+        for frame in range(10):
+            # Move all points by less than a quarter of the skin in total.
+            points = self.box.wrap(
+                points + np.random.uniform(
+                    -0.005, 0.005, points.shape).astype(np.float32))
+            vl.compute((self.box, points), query_args)
+            self.check_nlist(vl, points, query_args)
+        self.assertEqual(vl.num_builds, 1)
+
+    def test_rebuild(self):
+        vl = freud.locality.VerletList(self.skin)
+        query_args = dict(r_max=self.r_max, r_min=0.5, exclude_ii=True)
+        vl.compute((self.box, self.points), query_args)
+        self.assertEqual(vl.num_builds, 1)
+
+        # Moving a single point by more than half the skin forces a rebuild.
+        points = self.points.copy()
+        points[0, 0] += 0.75*self.skin
+        points = self.box.wrap(points)
+        vl.compute((self.box, points), query_args)
+        self.assertEqual(vl.num_builds, 2)
+        self.check_nlist(vl, points, query_args)
+
+        # Changing the query arguments forces a rebuild.
+        vl.compute((self.box, points), dict(r_max=1.2, exclude_ii=True))
+        self.assertEqual(vl.num_builds, 3)
+
+        # Resetting forces a rebuild.
+        vl.reset()
+        vl.compute((self.box, points), dict(r_max=1.2, exclude_ii=True))
+        self.assertEqual(vl.num_builds, 4)
+
+    def test_nlist_copy(self):
+        vl = freud.locality.VerletList(self.skin)
+        query_args = dict(r_max=self.r_max, exclude_ii=True)
+        vl.compute((self.box, self.points), query_args)
+        nlist = vl.nlist
+        bonds = np.copy(nlist[:])
+        distances = np.copy(nlist.distances)
+
+        # Later computes do not change a previously returned list.
+        points = self.box.wrap(self.points + np.float32(0.1))
+        vl.compute((self.box, points), query_args)
+        npt.assert_equal(nlist[:], bonds)
+        npt.assert_equal(nlist.distances, distances)
+
+    def test_nearest_invalid(self):
+        vl = freud.locality.VerletList(self.skin)
+        with self.assertRaises(ValueError):
+            vl.compute((self.box, self.points), dict(num_neighbors=4))
+
+    def test_repr(self):
+        vl = freud.locality.VerletList(self.skin)
+        self.assertEqual(str(vl), str(eval(repr(vl))))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -2,7 +2,7 @@ import numpy as np
 import numpy.testing as npt
 import freud
 import unittest
-from util import sort_rounded_xyz_array
+from util import sort_rounded_xyz_array, skipIfMissing
 
 
 class TestVoronoi(unittest.TestCase):
@@ -71,6 +71,30 @@ class TestVoronoi(unittest.TestCase):
         # Every (i, j) pair should have a corresponding (j, i) pair
         self.assertTrue(all((j, i) in jis for (i, j) in ijs))
 
+    def test_threads_3d(self):
+        # Test that the cells do not depend on the number of threads
+        L = 10  # Box length
+        N = 200  # Number of particles
+        box, points = freud.data.make_random_system(L, N, is2D=False)
+        vor = freud.locality.Voronoi()
+        with freud.parallel.NumThreads(1):
+            vor.compute((box, points))
+        volumes = np.copy(vor.volumes)
+        polytopes = [np.copy(p) for p in vor.polytopes]
+        nlist = vor.nlist.copy()
+
+        with freud.parallel.NumThreads(4):
+            vor.compute((box, points))
+
+        npt.assert_allclose(vor.volumes, volumes)
+        for polytope, expected in zip(vor.polytopes, polytopes):
+            npt.assert_allclose(polytope, expected)
+        npt.assert_equal(vor.nlist.query_point_indices,
+                         nlist.query_point_indices)
+        npt.assert_equal(vor.nlist.point_indices, nlist.point_indices)
+        npt.assert_allclose(vor.nlist.weights, nlist.weights)
+        npt.assert_allclose(vor.nlist.distances, nlist.distances)
+
     def test_voronoi_tess_2d(self):
         # Test that the voronoi polytope works for a 2D system
         L = 10  # Box length
@@ -178,6 +202,99 @@ class TestVoronoi(unittest.TestCase):
             points[vor.nlist.query_point_indices]), axis=-1)
         npt.assert_allclose(wrapped_distances, vor.nlist.distances)
 
+    def test_voronoi_2d_periodic_images(self):
+        # A single point neighbors its own periodic images on all four sides
+        L = 4  # Box length
+        box = freud.box.Box.square(L)
+        vor = freud.locality.Voronoi()
+        vor.compute((box, np.array([[1, 1, 0]], dtype=np.float32)))
+        npt.assert_almost_equal(vor.volumes, [L**2])
+        npt.assert_equal(vor.nlist[:], [[0, 0]] * 4)
+        npt.assert_almost_equal(vor.nlist.weights, L)
+        expected_polytope = sort_rounded_xyz_array(
+            [[-1, -1, 0], [3, -1, 0], [3, 3, 0], [-1, 3, 0]])
+        npt.assert_almost_equal(
+            sort_rounded_xyz_array(vor.polytopes[0]), expected_polytope)
+
+        # Points of a hexagonal lattice have six neighbors in a sheared box
+        n = 4  # Number of unit cells along each box vector
+        box = freud.box.Box(n, n * np.sqrt(3) / 2, xy=1 / np.sqrt(3),
+                            is2D=True)
+        points = np.array([[i + 0.5 * j, np.sqrt(3) / 2 * j, 0]
+                           for i in range(n) for j in range(n)])
+        vor.compute((box, box.wrap(points)))
+        npt.assert_equal(vor.nlist.neighbor_counts, 6)
+        npt.assert_allclose(vor.nlist.weights, 1 / np.sqrt(3), rtol=1e-5)
+        npt.assert_allclose(vor.nlist.distances, 1, rtol=1e-5)
+        npt.assert_allclose(vor.volumes, np.sqrt(3) / 2, rtol=1e-5)
+
+    @skipIfMissing('scipy.spatial')
+    def test_random_2d_reference(self):
+        # Compare the cells of a random 2D system to a Voronoi tessellation
+        # of its periodic images, whose edge lengths are the face areas of
+        # a prism of unit height like the previous voro++ slab container.
+        from scipy.spatial import Voronoi as ScipyVoronoi
+        L = 10  # Box length
+        N = 200  # Number of particles
+        box, points = freud.data.make_random_system(L, N, is2D=True, seed=1)
+        vor = freud.locality.Voronoi()
+        vor.compute((box, points))
+
+        # The cell areas fill the box
+        npt.assert_allclose(np.sum(vor.volumes), box.volume, rtol=1e-6)
+
+        # The neighbor list is symmetric, including the weights
+        bonds = {}
+        for i, j, weight in zip(vor.nlist.query_point_indices,
+                                vor.nlist.point_indices, vor.nlist.weights):
+            bonds.setdefault((i, j), []).append(weight)
+        for (i, j), weights in bonds.items():
+            npt.assert_allclose(sorted(weights), sorted(bonds[(j, i)]),
+                                rtol=1e-5)
+
+        # Tessellate the points and their eight nearest periodic images
+        images = np.array([[x, y, 0] for x in (-1, 0, 1) for y in (-1, 0, 1)])
+        tiled_points = np.concatenate(
+            [points + L * image for image in images])[:, :2]
+        reference = ScipyVoronoi(tiled_points)
+        center = 4 * N  # Index of the first point of the image (0, 0)
+        expected_bonds = {}
+        for (a, b), ridge in zip(reference.ridge_points,
+                                 reference.ridge_vertices):
+            vertices = reference.vertices[ridge]
+            weight = np.linalg.norm(vertices[1] - vertices[0])
+            for i, j in [(a, b), (b, a)]:
+                if center <= i < center + N:
+                    expected_bonds.setdefault(
+                        (i - center, j % N), []).append(weight)
+
+        expected_counts = np.zeros(N, dtype=np.uint32)
+        for (i, j), weights in expected_bonds.items():
+            expected_counts[i] += len(weights)
+        npt.assert_equal(vor.nlist.neighbor_counts, expected_counts)
+        self.assertEqual(set(bonds), set(expected_bonds))
+        for pair, weights in expected_bonds.items():
+            npt.assert_allclose(sorted(bonds[pair]), sorted(weights),
+                                rtol=1e-5, atol=1e-5)
+
+    def test_square_lattice_2d(self):
+        # Four cells meet at every vertex of a square lattice, which must not
+        # create bonds across edges of zero length.
+        n = 8  # Number of points along each box vector
+        a = 0.7  # Lattice spacing
+        box = freud.box.Box.square(n * a)
+        points = np.array([[a * (i + 0.5), a * (j + 0.5), 0]
+                           for i in range(n) for j in range(n)])
+        points = box.wrap(points).astype(np.float32)
+        vor = freud.locality.Voronoi()
+        vor.compute((box, points))
+        npt.assert_equal(len(vor.nlist), 4 * n * n)
+        npt.assert_equal(vor.nlist.neighbor_counts, 4)
+        npt.assert_allclose(vor.nlist.weights, a, rtol=1e-5)
+        npt.assert_allclose(vor.nlist.distances, a, rtol=1e-5)
+        npt.assert_allclose(vor.volumes, a * a, rtol=1e-5)
+        npt.assert_equal(np.array([len(p) for p in vor.polytopes]), 4)
+
     def test_voronoi_neighbors_wrapped(self):
         # Test that voronoi neighbors in the first shell are correct for a
         # wrapped 3D system, also tests multiple compute calls
@@ -247,6 +364,28 @@ class TestVoronoi(unittest.TestCase):
     def test_repr(self):
         vor = freud.locality.Voronoi()
         self.assertEqual(str(vor), str(eval(repr(vor))))
+        vor = freud.locality.Voronoi(neighbors_only=True)
+        self.assertEqual(str(vor), str(eval(repr(vor))))
+
+    def test_neighbors_only(self):
+        # Skipping the polytopes does not change the neighbors or volumes
+        L = 10  # Box length
+        N = 50  # Number of particles
+        for is2D in [True, False]:
+            box, points = freud.data.make_random_system(L, N, is2D=is2D)
+            vor = freud.locality.Voronoi()
+            vor.compute((box, points))
+            vor_neighbors = freud.locality.Voronoi(neighbors_only=True)
+            vor_neighbors.compute((box, points))
+
+            self.assertTrue(vor_neighbors.neighbors_only)
+            npt.assert_equal(vor.nlist[:], vor_neighbors.nlist[:])
+            npt.assert_equal(vor.nlist.distances,
+                             vor_neighbors.nlist.distances)
+            npt.assert_equal(vor.nlist.weights, vor_neighbors.nlist.weights)
+            npt.assert_equal(vor.volumes, vor_neighbors.volumes)
+            with self.assertRaises(AttributeError):
+                vor_neighbors.polytopes
 
     def test_attributes(self):
         # Test that the class attributes are protected
@@ -937,6 +937,27 @@ class TestPMFTXYZ(unittest.TestCase):
         npt.assert_equal(infcheck_noshift, 0)
         npt.assert_equal(infcheck_shift, 1)
 
+    def test_shared_histogram(self):
+        L = 10
+        box, points = freud.data.make_random_system(L, 1000, seed=0)
+        orientations = np.array([[1, 0, 0, 0]]*len(points))
+        pmft = freud.pmft.PMFTXYZ(2, 2, 2, 20)
+        self.assertFalse(pmft.shared_histogram)
+        pmft.compute((box, points), orientations)
+        bin_counts = np.copy(pmft.bin_counts)
+        self.assertGreater(np.sum(bin_counts), 0)
+
+        shared = freud.pmft.PMFTXYZ(2, 2, 2, 20)
+        shared.shared_histogram = True
+        self.assertTrue(shared.shared_histogram)
+        shared.compute((box, points), orientations)
+        npt.assert_array_equal(shared.bin_counts, bin_counts)
+
+        # Counts accumulated with and without sharing are summed
+        shared.shared_histogram = False
+        shared.compute((box, points), orientations, reset=False)
+        npt.assert_array_equal(shared.bin_counts, 2*bin_counts)
+
     def test_repr(self):
         max_x = 5.23
         max_y = 6.23